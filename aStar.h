@@ -0,0 +1,100 @@
+// aStar.h header file
+//
+// Implements A* search between two cells of a graph built from a maze.
+//
+// Every vertex of a maze graph knows its (row, column) cell, so the
+// Manhattan distance from a vertex's cell to the goal cell, scaled by the
+// smallest edge weight, is a lower bound on the weight still to go.
+// Vertices are taken in order of weight so far plus that bound, which
+// pulls the search toward the goal instead of spreading out evenly the way
+// dijkstra's does.  Among vertices with the same total, the one nearest
+// the goal is taken first, so on an open stretch the search runs straight
+// down one of the many equally short paths rather than fanning out across
+// all of them.
+//
+// When every edge joins cells one step apart, as in mapMazeToGraph, the
+// bound is consistent: it never drops by more than an edge's weight along
+// that edge.  A vertex's weight is then final when it is taken, so a taken
+// vertex is never looked at again.  Otherwise a taken vertex that later
+// improves is put back in the queue.
+
+#ifndef AStar_h
+#define AStar_h
+
+#include <stdlib.h>
+#include <vector>
+
+#include "d_except.h"
+#include "dHeap.h"
+#include "csrGraph.h"
+#include "searchContext.h"
+
+long long aStarKey(int dist, int bound)
+// Order by dist + bound, then by bound, in one comparable key.
+{
+	return ((long long)(dist + bound) << 32) | (unsigned)bound;
+}
+
+bool aStar(const csrGraph &g, int s, int t, searchContext &ctx, bool consistent = false)
+// find lowest weight from vertex s to vertex t in CSR graph g, which must
+// hold the maze cell of each vertex, leaving the weights and preds of the
+// explored region in ctx.  ctx.settled marks the vertices expanded
+// consistent says every edge joins cells one row or column apart, so no
+// vertex has to be expanded twice
+// all nums must be positive
+// returns true if t is accessible from node s
+{
+	if (!g.hasCells())
+		throw rangeError("graph has no cells in aStar");
+	if (g.numEdges() > 0 && g.minEdgeWeight() < 0)
+		throw rangeError("negative edge found");
+
+	vector<int> &dist = ctx.dist;
+	ctx.reset(g.numVertices(), s);
+
+	// lower bound on the weight from v to t
+	int step = g.numEdges() > 0 ? g.minEdgeWeight() : 0;
+	int goalRow = g.cell(t).first;
+	int goalCol = g.cell(t).second;
+	auto bound = [&](int v)
+	{
+		return step * (abs(g.cell(v).first - goalRow) + abs(g.cell(v).second - goalCol));
+	};
+
+	// vertices are queued when first reached
+	dHeap<long long, int, 4> q;
+	q.minHeapInsert(s, aStarKey(0, bound(s)));
+
+	while (!q.empty())
+	{
+		int u = q.extractMinHeapMinimum();
+		ctx.settled[u] = true;
+		if (u == t)
+			return true;
+
+		for (int e = g.beginEdge(u); e < g.endEdge(u); e++)
+		{
+			int v = g.target(e);
+			int d = dist[u] + g.weight(e);
+			if (d >= dist[v])
+				continue;
+			if (consistent && ctx.settled[v])
+				continue;
+
+			bool reached = dist[v] != LargeValue;
+			dist[v] = d;
+			ctx.pred[v] = u;
+			if (reached && q.contains(v))
+				q.minHeapDecreaseKey(v, aStarKey(d, bound(v)));
+			else
+			{
+				// first reached, or reopened after being expanded
+				ctx.settled[v] = false;
+				q.minHeapInsert(v, aStarKey(d, bound(v)));
+			}
+		}
+	}
+	return false;
+}
+
+#endif
@@ -0,0 +1,285 @@
+// allPairs.h header file
+//
+// All pairs shortest paths: the weight of the lowest weight path from every
+// vertex to every other, as a numVertices x numVertices matrix whose row s
+// holds the weights from s.
+//
+// johnson suits sparse graphs.  A Bellman-Ford, which the caller passes in
+// as it does the dijkstra, from an extra vertex with a 0 weight edge to
+// every vertex gives each vertex v a potential h[v], and
+// reweighting each edge (u, v) to w + h[u] - h[v] makes every weight
+// non-negative without changing which paths are shortest.  A dijkstra from
+// each source over the reweighted graph then gives that source's row.  The
+// sources are shared out among threads the way batchQuery.h shares out
+// queries, each thread reusing one searchContext.
+//
+// floydWarshall suits dense graphs.  It works on the matrix itself, a
+// square block at a time, so the three blocks each step reads stay in
+// cache, and takes the min along a row eight entries at a time with AVX2
+// when the compiler targets it, or four at a time with the SSE2 every
+// x64 compiler can use.
+//
+// Both return false if the graph has a negative cycle anywhere, as
+// bellmanFord does for one reachable from its source.  Otherwise an entry
+// is LargeValue where there is no path.
+
+#ifndef AllPairs_h
+#define AllPairs_h
+
+#include <algorithm>
+#include <atomic>
+#include <limits.h>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "d_matrix.h"
+#include "csrGraph.h"
+#include "searchContext.h"
+
+// rows and columns in a floydWarshall block; three blocks of ints fit in a
+// typical 64KB of L1 and L2 with room to spare
+#define AllPairsBlock 64
+
+// graphs with at least this fraction of the numVertices^2 possible edges
+// are solved with floydWarshall.  On 1500 vertices with one thread,
+// johnson caught up with floydWarshall at about 3% with AVX2 and 8%
+// without it; johnson's threads move the point up.
+#ifdef __AVX2__
+#define AllPairsDenseFraction 0.03
+#else
+#define AllPairsDenseFraction 0.08
+#endif
+
+enum allPairsMethod
+{
+	johnsonAllPairs,        // Bellman-Ford potentials, then dijkstra from each source
+	floydWarshallAllPairs,  // blocked Floyd-Warshall over the matrix
+	autoAllPairs            // pick one by the graph's density
+};
+
+allPairsMethod chooseAllPairs(allPairsMethod method, const csrGraph &g)
+// Resolve autoAllPairs.  johnson's dijkstras cost a heap operation per
+// edge per source, floydWarshall a fraction of that per matrix entry per
+// vertex, so floydWarshall wins once a graph holds a few percent of its
+// possible edges.
+{
+	if (method != autoAllPairs)
+		return method;
+	double n = g.numVertices();
+	return g.numEdges() >= AllPairsDenseFraction * n * n ? floydWarshallAllPairs : johnsonAllPairs;
+}
+
+template <typename Potentials, typename Solve>
+bool johnson(const csrGraph &g, matrix<int> &dist, Potentials potentials, Solve solve,
+	int numThreads = 0)
+// Fill dist with the weight of the lowest weight path between every pair
+// of vertices in g, using numThreads threads (0 for one per core).
+// potentials(g, s, ctx) is a Bellman-Ford: it must leave the weights from s
+// in ctx and return false on a negative cycle reachable from s.  It runs
+// once, serially, and should stop as soon as the weights settle, as
+// bellmanFordQueue does, since that step can otherwise cost more than all
+// the dijkstras.  solve(g, s, ctx) must leave the weights from s in ctx;
+// it is only given graphs without negative weights.
+// will return false if it detects a negative cycle
+{
+	int n = g.numVertices();
+	dist = matrix<int>(n, n, LargeValue);
+
+	// The potentials are all 0 when no weight is negative, and then the
+	// graph needs no reweighting
+	vector<int> h(n, 0);
+	const csrGraph *search = &g;
+	csrGraph reweighted;
+	if (g.minEdgeWeight() < 0)
+	{
+		vector<int> edges;
+		edges.reserve(3 * ((size_t)g.numEdges() + n));
+		for (int u = 0; u < n; u++)
+			for (int e = g.beginEdge(u); e < g.endEdge(u); e++)
+			{
+				edges.push_back(u);
+				edges.push_back(g.target(e));
+				edges.push_back(g.weight(e));
+			}
+		// the extra vertex n reaches every vertex, so a negative cycle
+		// anywhere in g is reachable from it
+		for (int v = 0; v < n; v++)
+		{
+			edges.push_back(n);
+			edges.push_back(v);
+			edges.push_back(0);
+		}
+		searchContext ctx;
+		if (!potentials(csrGraph(n + 1, edges), n, ctx))
+			return false;
+		copy(ctx.dist.begin(), ctx.dist.begin() + n, h.begin());
+
+		edges.resize(3 * (size_t)g.numEdges());
+		for (size_t k = 0; k < edges.size(); k += 3)
+			edges[k + 2] += h[edges[k]] - h[edges[k + 1]];
+		reweighted = csrGraph(n, edges);
+		search = &reweighted;
+	}
+
+	if (numThreads <= 0)
+		numThreads = max(1, (int)thread::hardware_concurrency());
+	numThreads = min(numThreads, max(1, n));
+	atomic<int> next(0);
+
+	// Take sources until none are left, undoing the reweighting on the way
+	// into the matrix
+	auto work = [&]()
+	{
+		searchContext ctx;
+		int s;
+		while ((s = next++) < n)
+		{
+			solve(*search, s, ctx);
+			int *row = dist.data() + (size_t)s * n;
+			for (int v = 0; v < n; v++)
+				if (ctx.dist[v] != LargeValue)
+					row[v] = ctx.dist[v] - h[s] + h[v];
+		}
+	};
+
+	vector<thread> workers;
+	for (int t = 1; t < numThreads; t++)
+		workers.push_back(thread(work));
+	// The calling thread works too
+	work();
+	for (int t = 0; t < (int)workers.size(); t++)
+		workers[t].join();
+
+	return true;
+}
+
+// floydWarshall's weight for no path.  It is far above any real path
+// weight, which stays under LargeValue, and the sum of two entries, which
+// are kept between -AllPairsInfinity and AllPairsInfinity, can't overflow.
+// A sum that involves it only ever lands within a path's weight of it, so
+// anything over half of it still means no path.
+#define AllPairsInfinity (INT_MAX / 2)
+
+void relaxBlock(int *d, int n, int i0, int i1, int j0, int j1, int k0, int k1)
+// For k from k0 to k1 - 1, lower d[i][j] to d[i][k] + d[k][j] where that
+// is smaller, over rows i0 to i1 - 1 and columns j0 to j1 - 1 of the n x n
+// matrix d.  Sums are held at -AllPairsInfinity, so a negative cycle can't
+// drive them past the end of an int before it is noticed.
+{
+	for (int k = k0; k < k1; k++)
+	{
+		const int *rowK = d + (size_t)k * n;
+		for (int i = i0; i < i1; i++)
+		{
+			int *rowI = d + (size_t)i * n;
+			int dik = rowI[k];
+			// nothing gets through a vertex i can't reach
+			if (dik > AllPairsInfinity / 2)
+				continue;
+			int j = j0;
+#ifdef __AVX2__
+			__m256i vik = _mm256_set1_epi32(dik);
+			__m256i floor = _mm256_set1_epi32(-AllPairsInfinity);
+			for (; j + 8 <= j1; j += 8)
+			{
+				__m256i kj = _mm256_loadu_si256((const __m256i *)(rowK + j));
+				__m256i ij = _mm256_loadu_si256((const __m256i *)(rowI + j));
+				__m256i via = _mm256_max_epi32(_mm256_add_epi32(vik, kj), floor);
+				_mm256_storeu_si256((__m256i *)(rowI + j), _mm256_min_epi32(ij, via));
+			}
+#elif defined(__SSE2__) || defined(_M_X64)
+			// SSE2 has no min or max of 32 bit ints, so they are made from
+			// a compare and a select
+			__m128i vik = _mm_set1_epi32(dik);
+			__m128i floor = _mm_set1_epi32(-AllPairsInfinity);
+			for (; j + 4 <= j1; j += 4)
+			{
+				__m128i kj = _mm_loadu_si128((const __m128i *)(rowK + j));
+				__m128i ij = _mm_loadu_si128((const __m128i *)(rowI + j));
+				__m128i via = _mm_add_epi32(vik, kj);
+				__m128i low = _mm_cmplt_epi32(via, floor);
+				via = _mm_or_si128(_mm_and_si128(low, floor), _mm_andnot_si128(low, via));
+				__m128i less = _mm_cmplt_epi32(via, ij);
+				_mm_storeu_si128((__m128i *)(rowI + j),
+					_mm_or_si128(_mm_and_si128(less, via), _mm_andnot_si128(less, ij)));
+			}
+#endif
+			for (; j < j1; j++)
+				rowI[j] = min(rowI[j], max(dik + rowK[j], -AllPairsInfinity));
+		}
+	}
+}
+
+bool floydWarshall(const csrGraph &g, matrix<int> &dist)
+// Fill dist with the weight of the lowest weight path between every pair
+// of vertices in g.
+// will return false if it detects a negative cycle
+{
+	int n = g.numVertices();
+	dist = matrix<int>(n, n, AllPairsInfinity);
+	int *d = dist.data();
+	for (int u = 0; u < n; u++)
+	{
+		d[(size_t)u * n + u] = 0;
+		// keep the lightest of parallel edges; a negative self loop stays
+		// on the diagonal as a negative cycle
+		for (int e = g.beginEdge(u); e < g.endEdge(u); e++)
+		{
+			int &duv = d[(size_t)u * n + g.target(e)];
+			duv = min(duv, g.weight(e));
+		}
+	}
+
+	// For each block of intermediate vertices k, the block on the diagonal
+	// goes first, since the rest of its row and column of blocks read it;
+	// those go next, since every other block reads them
+	for (int k0 = 0; k0 < n; k0 += AllPairsBlock)
+	{
+		int k1 = min(n, k0 + AllPairsBlock);
+		relaxBlock(d, n, k0, k1, k0, k1, k0, k1);
+		for (int b = 0; b < n; b += AllPairsBlock)
+			if (b != k0)
+			{
+				relaxBlock(d, n, k0, k1, b, min(n, b + AllPairsBlock), k0, k1);
+				relaxBlock(d, n, b, min(n, b + AllPairsBlock), k0, k1, k0, k1);
+			}
+		for (int i0 = 0; i0 < n; i0 += AllPairsBlock)
+			if (i0 != k0)
+				for (int j0 = 0; j0 < n; j0 += AllPairsBlock)
+					if (j0 != k0)
+						relaxBlock(d, n, i0, min(n, i0 + AllPairsBlock), j0,
+							min(n, j0 + AllPairsBlock), k0, k1);
+
+		// a vertex with a path to itself below 0 is on a negative cycle;
+		// stop as soon as one shows up
+		for (int v = 0; v < n; v++)
+			if (d[(size_t)v * n + v] < 0)
+				return false;
+	}
+
+	for (size_t k = 0; k < (size_t)n * n; k++)
+		if (d[k] > AllPairsInfinity / 2)
+			d[k] = LargeValue;
+	return true;
+}
+
+template <typename Potentials, typename Solve>
+bool allPairs(const csrGraph &g, matrix<int> &dist, Potentials potentials, Solve solve,
+	allPairsMethod method = autoAllPairs, int numThreads = 0)
+// Fill dist with the weight of the lowest weight path between every pair
+// of vertices in g, by method, picking one by density for autoAllPairs.
+// potentials, solve and numThreads are as for johnson.
+// will return false if it detects a negative cycle
+{
+	if (chooseAllPairs(method, g) == floydWarshallAllPairs)
+		return floydWarshall(g, dist);
+	return johnson(g, dist, potentials, solve, numThreads);
+}
+
+#endif
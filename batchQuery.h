@@ -0,0 +1,112 @@
+// batchQuery.h header file
+//
+// Answers a batch of (source, target) queries against one shared graph.
+//
+// The graph is only read, so every worker thread searches it directly.
+// Each worker owns one searchContext and reuses it for every query it
+// takes, so a query costs no allocation beyond its result path.  Workers
+// take the next unanswered query from a shared counter, which keeps them
+// all busy when queries differ in cost, and store each result at the
+// query's own index, so results come back in input order.
+
+#ifndef BatchQuery_h
+#define BatchQuery_h
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "d_except.h"
+#include "csrGraph.h"
+#include "searchContext.h"
+
+struct query
+{
+	int source;
+	int target;
+};
+
+struct queryResult
+{
+	bool ok;             // false if the search failed, e.g. on a negative weight
+	int dist;            // length of the shortest path, or LargeValue if there is none
+	vector<int> path;    // vertices from source to target, empty if there is no path
+};
+
+void tracePath(const searchContext &ctx, int source, int target, vector<int> &path)
+// Follow preds back from target to build the path from source to target.
+// Leaves path empty if target was not reached.
+{
+	path.clear();
+	if (ctx.dist[target] == LargeValue)
+		return;
+
+	// A pred chain can only be longer than the vertex count if it loops
+	int limit = (int)ctx.pred.size();
+	for (int v = target; v != LargeValue && limit-- >= 0; v = ctx.pred[v])
+		path.push_back(v);
+	if (path.back() != source)
+	{
+		path.clear();
+		return;
+	}
+	reverse(path.begin(), path.end());
+}
+
+template <typename Solve>
+void answerQueries(const csrGraph &g, const vector<query> &queries,
+	vector<queryResult> &results, atomic<int> &next, Solve solve)
+// Worker loop: take queries until none are left.
+{
+	searchContext ctx;
+	int i;
+	while ((i = next++) < (int)queries.size())
+	{
+		const query &q = queries[i];
+		queryResult &r = results[i];
+		try
+		{
+			if (q.source < 0 || q.source >= g.numVertices() ||
+				q.target < 0 || q.target >= g.numVertices())
+				throw rangeError("query vertex out of range");
+			solve(g, q.source, q.target, ctx);
+			r.ok = true;
+			r.dist = ctx.dist[q.target];
+			tracePath(ctx, q.source, q.target, r.path);
+		}
+		catch (baseException &)
+		{
+			r.ok = false;
+			r.dist = LargeValue;
+			r.path.clear();
+		}
+	}
+}
+
+template <typename Solve>
+vector<queryResult> runQueries(const csrGraph &g, const vector<query> &queries,
+	Solve solve, int numThreads = 0)
+// Answer every query with solve(g, source, target, ctx), which must leave
+// the distances and preds of its search in ctx.  Uses numThreads workers,
+// or one per hardware thread if numThreads is 0.
+{
+	if (numThreads <= 0)
+		numThreads = max(1, (int)thread::hardware_concurrency());
+	numThreads = min(numThreads, max(1, (int)queries.size()));
+
+	vector<queryResult> results(queries.size());
+	atomic<int> next(0);
+
+	vector<thread> workers;
+	for (int t = 1; t < numThreads; t++)
+		workers.push_back(thread([&]() { answerQueries(g, queries, results, next, solve); }));
+	// The calling thread works too
+	answerQueries(g, queries, results, next, solve);
+	for (int t = 0; t < (int)workers.size(); t++)
+		workers[t].join();
+
+	return results;
+}
+
+#endif
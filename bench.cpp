@@ -0,0 +1,473 @@
+// bench.cpp
+//
+// Benchmarks for the graph and maze code, run on the bundled inputs or on
+// the files named on the command line.
+//
+//   bench [-warmup n] [-reps n] [-filter text] [-save file]
+//         [-baseline file] [-threshold percent] [-floor ms] [file...]
+//
+// For every graph file it times reading the file into a Boost graph with
+// initializeGraph and into a csrGraph with loadGraph, building a csrGraph
+// from the edges alone, dijkstra's on both kinds of graph, Bellman-Ford on
+// both, the parallel Bellman-Ford and a run of heapV operations.  For
+// every maze it times reading the file, both versions of mapMazeToGraph,
+// dijkstra's on both versions of the maze's graph, the two breadth-first
+// searches and rendering the path as a single frame.  Graphs without negative weights
+// and mazes also time deltaStepping on 1 thread up to one per hardware
+// thread, with each count's speedup over 1 thread.
+//
+// Each benchmark is run warmup times untimed and then reps times timed,
+// and the median, 95th percentile and fastest time are reported in
+// milliseconds.  -filter keeps only the benchmarks whose names contain the
+// text.  -save writes the results to a file, which a later run can be
+// compared against with -baseline: a benchmark whose median is more than
+// threshold percent (default 10) slower than the baseline's is flagged as a
+// regression, unless the difference is under floor milliseconds (default
+// 0.05), which keeps timer noise on the small inputs from being flagged.
+// The exit status is 1 if anything regressed.
+//
+// Build it on its own, as main.cpp's functions are compiled in with it;
+// see readme.txt.
+
+#define LicNoMain
+#include "main.cpp"
+
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <streambuf>
+
+struct benchResult
+{
+	string name;
+	double median;
+	double p95;
+	double fastest;
+};
+
+// settings from the command line
+struct benchOptions
+{
+	int warmup;
+	int reps;
+	string filter;
+
+	benchOptions() : warmup(2), reps(10) {}
+};
+
+// a stream buffer that throws away what is written to it, to time
+// rendering without the cost of a terminal or file
+class nullBuffer : public streambuf
+{
+protected:
+	int overflow(int c) { return c; }
+	streamsize xsputn(const char *, streamsize n) { return n; }
+};
+
+// time run, which returns the milliseconds taken by the part of it that is
+// being measured, and add the result to results.  skipped if name doesn't
+// pass the filter
+template <typename Run>
+void measure(const string &name, const benchOptions &opt, vector<benchResult> &results, Run run)
+{
+	if (name.find(opt.filter) == string::npos)
+		return;
+	for (int k = 0; k < opt.warmup; k++)
+		run();
+	vector<double> times;
+	for (int k = 0; k < opt.reps; k++)
+		times.push_back(run());
+	sort(times.begin(), times.end());
+
+	// nearest rank percentiles
+	benchResult r;
+	r.name = name;
+	r.median = times[(times.size() - 1) / 2];
+	r.p95 = times[(size_t)ceil(0.95 * times.size()) - 1];
+	r.fastest = times[0];
+	results.push_back(r);
+	printf("%-36s %12.3f %12.3f %12.3f\n", name.c_str(), r.median, r.p95, r.fastest);
+	fflush(stdout);
+}
+
+// time deltaStepping from s over g on 1 thread up to one per hardware
+// thread, and print the speedup of each count over a single thread
+void benchScaling(const string &name, const csrGraph &g, int s, const benchOptions &opt,
+	vector<benchResult> &results)
+{
+	int most = max(1, (int)thread::hardware_concurrency());
+	searchContext ctx;
+	double single = 0;
+	for (int t = 1; t <= most; t++)
+	{
+		size_t before = results.size();
+		measure(name + " deltaStepping " + to_string(t) + "t", opt, results, [&]()
+		{
+			stopwatch clock;
+			deltaStepping(g, s, ctx, 0, t);
+			return clock.ms();
+		});
+		if (results.size() == before)
+			continue;
+		if (t == 1)
+			single = results.back().median;
+		if (single > 0 && results.back().median > 0)
+			printf("%-36s %11.2fx\n", "  speedup over 1 thread", single / results.back().median);
+	}
+}
+
+// the benchmarks for graph file fileName, named after the file
+void benchGraph(const string &fileName, const benchOptions &opt, vector<benchResult> &results)
+{
+	csrGraph g;
+	int start, end;
+	loadGraph(fileName, g, start, end);
+	bool negative = g.numEdges() > 0 && g.minEdgeWeight() < 0;
+
+	measure(fileName + " initializeGraph", opt, results, [&]()
+	{
+		stopwatch clock;
+		ifstream fin(fileName.c_str());
+		Graph bg;
+		Vertex s, t;
+		initializeGraph(bg, s, t, fin);
+		return clock.ms();
+	});
+	measure(fileName + " loadGraph", opt, results, [&]()
+	{
+		stopwatch clock;
+		csrGraph h;
+		int s, t;
+		loadGraph(fileName, h, s, t);
+		return clock.ms();
+	});
+
+	// the edges as loadGraph passes them to csrGraph
+	vector<int> triples;
+	for (int u = 0; u < g.numVertices(); u++)
+		for (int e = g.beginEdge(u); e < g.endEdge(u); e++)
+		{
+			triples.push_back(u);
+			triples.push_back(g.target(e));
+			triples.push_back(g.weight(e));
+		}
+	measure(fileName + " csrGraph build", opt, results, [&]()
+	{
+		stopwatch clock;
+		csrGraph h(g.numVertices(), triples);
+		return clock.ms();
+	});
+
+	ifstream fin(fileName.c_str());
+	Graph bg;
+	Vertex bs, bt;
+	initializeGraph(bg, bs, bt, fin);
+	fin.close();
+
+	searchContext ctx, bwd;
+	if (!negative)
+	{
+		measure(fileName + " dijkstra heapV", opt, results, [&]()
+		{
+			stopwatch clock;
+			dijkstra(bg, bs, binaryHeapQueue);
+			return clock.ms();
+		});
+		measure(fileName + " dijkstra csr", opt, results, [&]()
+		{
+			stopwatch clock;
+			dijkstra(g, start, end, ctx);
+			return clock.ms();
+		});
+		// the reverse graph is built once per query outside of batch mode,
+		// so its cost is shown beside the search it serves
+		measure(fileName + " csrGraph reverse", opt, results, [&]()
+		{
+			stopwatch clock;
+			csrGraph h = g.reversed();
+			return clock.ms();
+		});
+		csrGraph rev = g.reversed();
+		measure(fileName + " dijkstra bidirectional", opt, results, [&]()
+		{
+			stopwatch clock;
+			bidirectionalDijkstra(g, rev, start, end, ctx, bwd);
+			return clock.ms();
+		});
+		benchScaling(fileName, g, start, opt, results);
+	}
+	measure(fileName + " bellmanFord", opt, results, [&]()
+	{
+		stopwatch clock;
+		bellmanFord(bg, bs);
+		return clock.ms();
+	});
+	measure(fileName + " bellmanFord csr", opt, results, [&]()
+	{
+		stopwatch clock;
+		bellmanFord(g, start, ctx);
+		return clock.ms();
+	});
+	measure(fileName + " bellmanFordQueue", opt, results, [&]()
+	{
+		stopwatch clock;
+		bellmanFordQueue(g, start, ctx);
+		return clock.ms();
+	});
+	// one thread per core; the in edge lists are built once, as the sweep
+	// does before timing the search
+	inEdgeList in(g);
+	measure(fileName + " bellmanFordParallel", opt, results, [&]()
+	{
+		stopwatch clock;
+		bellmanFordParallel(in, start, ctx);
+		return clock.ms();
+	});
+
+	// heapV: build a min heap over every vertex, lower each vertex's weight
+	// once, then take them all out again.  the weights are a fixed
+	// scramble of the vertex numbers, so every run does the same work
+	int n = (int)num_vertices(bg);
+	measure(fileName + " heapV operations", opt, results, [&]()
+	{
+		for (int v = 0; v < n; v++)
+			bg[v].weight = (int)(((unsigned)v * 2654435761u) >> 8);
+		vector<Vertex> all;
+		for (int v = 0; v < n; v++)
+			all.push_back(v);
+
+		stopwatch clock;
+		heapV<Vertex, Graph> q;
+		q.initializeMinHeap(all, bg);
+		for (int v = 0; v < n; v++)
+		{
+			bg[v].weight /= 2;
+			q.minHeapDecreaseKey(q.getIndex(all[v]), bg);
+		}
+		while (q.size() > 0)
+			q.extractMinHeapMinimum(bg);
+		return clock.ms();
+	});
+}
+
+// the benchmarks for maze file fileName, named after the file.  mazes are
+// solved from the top left cell to the bottom right one
+void benchMaze(const string &fileName, const benchOptions &opt, vector<benchResult> &results)
+{
+	maze m(fileName);
+	pair<int, int> start(0, 0), goal(m.numRows() - 1, m.numCols() - 1);
+
+	measure(fileName + " maze load", opt, results, [&]()
+	{
+		stopwatch clock;
+		maze copy(fileName);
+		return clock.ms();
+	});
+	measure(fileName + " mapMazeToGraph boost", opt, results, [&]()
+	{
+		stopwatch clock;
+		Graph bg;
+		m.mapMazeToGraph(bg);
+		return clock.ms();
+	});
+	csrGraph g;
+	measure(fileName + " mapMazeToGraph csr", opt, results, [&]()
+	{
+		stopwatch clock;
+		m.mapMazeToGraph(g);
+		return clock.ms();
+	});
+	m.mapMazeToGraph(g);
+
+	searchContext ctx;
+	bool ends = m.isLegal(start.first, start.second) && m.isLegal(goal.first, goal.second);
+	if (ends)
+	{
+		int s = (int)m.getNode(start.first, start.second);
+		int t = (int)m.getNode(goal.first, goal.second);
+		Graph bg;
+		m.mapMazeToGraph(bg);
+		Vertex bs = m.getNode(start.first, start.second);
+		measure(fileName + " dijkstra heapV", opt, results, [&]()
+		{
+			stopwatch clock;
+			dijkstra(bg, bs, binaryHeapQueue);
+			return clock.ms();
+		});
+		measure(fileName + " dijkstra csr", opt, results, [&]()
+		{
+			stopwatch clock;
+			dijkstra(g, s, t, ctx);
+			return clock.ms();
+		});
+		benchScaling(fileName, g, s, opt, results);
+	}
+
+	gridView gv(m);
+	measure(fileName + " gridBFS", opt, results, [&]()
+	{
+		stopwatch clock;
+		gridBFS(gv, gv.index(start.first, start.second), gv.index(goal.first, goal.second), ctx);
+		return clock.ms();
+	});
+	measure(fileName + " bitmapBFS", opt, results, [&]()
+	{
+		stopwatch clock;
+		bitmapBFS(m, start, goal);
+		return clock.ms();
+	});
+
+	// the path found by gridBFS, drawn on one frame
+	gridBFS(gv, gv.index(start.first, start.second), gv.index(goal.first, goal.second), ctx);
+	vector<int> path;
+	tracePath(ctx, gv.index(start.first, start.second), gv.index(goal.first, goal.second), path);
+	measure(fileName + " printPath frame", opt, results, [&]()
+	{
+		stack<pair<int, int> > s;
+		for (int k = (int)path.size() - 1; k >= 0; k--)
+			s.push(gv.cell(path[k]));
+		nullBuffer sink;
+		streambuf *old = cout.rdbuf(&sink);
+		stopwatch clock;
+		m.printPath(goal, s, PrintWholePath);
+		double ms = clock.ms();
+		cout.rdbuf(old);
+		return ms;
+	});
+}
+
+bool readResults(const string &fileName, map<string, benchResult> &results)
+// Read results written by writeResults into results, keyed by name.
+// Returns false if the file can't be opened.
+{
+	ifstream in(fileName.c_str());
+	if (!in)
+		return false;
+	string line;
+	while (getline(in, line))
+	{
+		// the name may hold spaces; the three times follow a tab
+		size_t tab = line.find('\t');
+		if (tab == string::npos)
+			continue;
+		benchResult r;
+		r.name = line.substr(0, tab);
+		istringstream times(line.substr(tab + 1));
+		if (times >> r.median >> r.p95 >> r.fastest)
+			results[r.name] = r;
+	}
+	return true;
+}
+
+void writeResults(const string &fileName, const vector<benchResult> &results)
+// Write results to fileName, one per line: the name, a tab, then the
+// median, 95th percentile and fastest times.
+{
+	ofstream out(fileName.c_str());
+	if (!out)
+		throw fileOpenError(fileName);
+	out.precision(6);
+	for (size_t k = 0; k < results.size(); k++)
+		out << results[k].name << "\t" << results[k].median << " " << results[k].p95
+			<< " " << results[k].fastest << "\n";
+}
+
+int compareResults(const vector<benchResult> &results, const map<string, benchResult> &baseline,
+	double threshold, double floorMs)
+// Print each result's median against the baseline's, flagging the ones
+// that are more than threshold percent and floorMs milliseconds slower.
+// Returns the number flagged.
+{
+	int regressions = 0;
+	printf("\n%-36s %12s %12s %9s\n", "benchmark", "baseline", "median", "change");
+	for (size_t k = 0; k < results.size(); k++)
+	{
+		const benchResult &r = results[k];
+		map<string, benchResult>::const_iterator b = baseline.find(r.name);
+		if (b == baseline.end())
+		{
+			printf("%-36s %12s %12.3f %9s\n", r.name.c_str(), "-", r.median, "new");
+			continue;
+		}
+		double base = b->second.median;
+		double change = base > 0 ? 100 * (r.median - base) / base : 0;
+		bool slower = change > threshold && r.median - base > floorMs;
+		regressions += slower;
+		printf("%-36s %12.3f %12.3f %+8.1f%%%s\n", r.name.c_str(), base, r.median, change,
+			slower ? "  REGRESSION" : "");
+	}
+	return regressions;
+}
+
+int main(int argc, char *argv[])
+{
+	benchOptions opt;
+	string saveFile, baselineFile;
+	double threshold = 10, floorMs = 0.05;
+
+	int a = 1;
+	for (; a + 1 < argc && argv[a][0] == '-'; a += 2)
+	{
+		string option = argv[a], value = argv[a + 1];
+		if (option == "-warmup")
+			opt.warmup = max(0, atoi(value.c_str()));
+		else if (option == "-reps")
+			opt.reps = max(1, atoi(value.c_str()));
+		else if (option == "-filter")
+			opt.filter = value;
+		else if (option == "-save")
+			saveFile = value;
+		else if (option == "-baseline")
+			baselineFile = value;
+		else if (option == "-threshold")
+			threshold = atof(value.c_str());
+		else if (option == "-floor")
+			floorMs = atof(value.c_str());
+		else
+		{
+			cerr << "bad option " << option << " " << value << endl;
+			return 2;
+		}
+	}
+
+	vector<string> files(argv + a, argv + argc);
+	if (files.empty())
+	{
+		for (int k = 1; k <= 10; k++)
+			files.push_back("graph" + to_string(k) + ".txt");
+		for (int k = 1; k <= 8; k++)
+			files.push_back("maze" + to_string(k) + ".txt");
+	}
+
+	map<string, benchResult> baseline;
+	if (!baselineFile.empty() && !readResults(baselineFile, baseline))
+	{
+		cerr << "Cannot open \"" << baselineFile << "\"" << endl;
+		return 2;
+	}
+
+	printf("%d warm-up and %d timed runs each, times in ms\n", opt.warmup, opt.reps);
+	printf("%-36s %12s %12s %12s\n", "benchmark", "median", "p95", "fastest");
+	vector<benchResult> results;
+	for (size_t k = 0; k < files.size(); k++)
+	{
+		try
+		{
+			if (isMazeFile(files[k]))
+				benchMaze(files[k], opt, results);
+			else
+				benchGraph(files[k], opt, results);
+		}
+		catch (baseException e)
+		{
+			cerr << files[k] << ": " << e.what() << endl;
+		}
+	}
+
+	if (!saveFile.empty())
+		writeResults(saveFile, results);
+	if (!baselineFile.empty() && compareResults(results, baseline, threshold, floorMs) > 0)
+		return 1;
+	return 0;
+}
@@ -0,0 +1,193 @@
+// binaryCache.h header file
+//
+// A binary cache format for graphs and mazes, meant to be mapped into
+// memory and used where it lies.
+//
+// A graph cache is a graphCacheHeader followed by the CSR arrays: the
+// numVertices + 1 offsets, then the numEdges targets, then the numEdges
+// weights, all 32-bit ints.  A maze cache is a mazeCacheHeader followed by
+// the open-cell bitmap, rows * wordsPerRow 64-bit words laid out as
+// maze::bitmap() describes.  Both headers are a multiple of 8 bytes, so
+// every array is aligned once the file is mapped at a page boundary.
+//
+// Numbers are stored in the byte order of the machine that wrote them.
+// The version field doubles as a check on that: read on a machine of the
+// other order it comes out as a different number and the file is refused.
+// Loading checks the header and the file's size against it, and the parts
+// of the arrays that would send a search outside them: that the offsets
+// run from 0 to numEdges without going back, that each target is a vertex
+// and each weight lies in the header's range, and that a maze's bitmap has
+// no bits set past its last column.  The offsets and the bitmap cost a
+// pass over rows or vertices; the targets and weights cost a pass over the
+// edges, which CacheCheckEdges can turn off for graphs big enough that
+// reading them all up front defeats the point of mapping them.
+
+#ifndef BinaryCache_h
+#define BinaryCache_h
+
+#include <fstream>
+#include <memory>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+#include "d_except.h"
+#include "csrGraph.h"
+#include "mappedFile.h"
+
+// bump when the layout of either format changes
+#define CacheVersion 1
+
+// set to 0 to trust a graph cache's targets and weights instead of
+// checking each one on load
+#ifndef CacheCheckEdges
+#define CacheCheckEdges 1
+#endif
+
+struct graphCacheHeader
+{
+	char magic[4];        // "LICG"
+	uint32_t version;     // CacheVersion
+	int32_t numVertices;
+	int32_t numEdges;
+	int32_t start;        // start vertex of the graph file
+	int32_t end;          // end vertex of the graph file
+	int32_t minWeight;    // range of the edge weights
+	int32_t maxWeight;
+};
+
+struct mazeCacheHeader
+{
+	char magic[4];        // "LICM"
+	uint32_t version;     // CacheVersion
+	int32_t rows;
+	int32_t cols;
+	int32_t wordsPerRow;
+	int32_t unused;       // keeps the bitmap 8-byte aligned
+};
+
+bool hasMagic(const mappedFile &file, const char *magic)
+// Return true if file starts with the four bytes at magic.
+{
+	return file.size() >= 4 && memcmp(file.data(), magic, 4) == 0;
+}
+
+void checkCacheHeader(const string &fileName, const mappedFile &file, size_t headerSize,
+	uint32_t version)
+// Throw fileError if file is too short for its header or has the wrong
+// version.
+{
+	if (file.size() < headerSize)
+		throw fileError(fileName + ": cache header is cut short");
+	if (version != CacheVersion)
+		throw fileError(fileName + ": cache was written by another version or on a machine "
+			"of the other byte order; convert the text file again");
+}
+
+void writeCache(const string &fileName, const void *header, size_t headerSize,
+	const void *const *arrays, const size_t *sizes, int numArrays)
+// Write header and then each array to fileName.  Throws fileOpenError if
+// the file can't be written.
+{
+	ofstream out(fileName.c_str(), ios::binary | ios::trunc);
+	if (!out)
+		throw fileOpenError(fileName);
+	out.write((const char *)header, headerSize);
+	for (int k = 0; k < numArrays; k++)
+		out.write((const char *)arrays[k], sizes[k]);
+	if (!out)
+		throw fileOpenError(fileName);
+}
+
+void saveGraphCache(const string &fileName, const csrGraph &g, int start, int end)
+// Write g, with its start and end vertices, to fileName as a graph cache.
+{
+	graphCacheHeader h;
+	memcpy(h.magic, "LICG", 4);
+	h.version = CacheVersion;
+	h.numVertices = g.numVertices();
+	h.numEdges = g.numEdges();
+	h.start = start;
+	h.end = end;
+	h.minWeight = g.minEdgeWeight();
+	h.maxWeight = g.maxEdgeWeight();
+
+	const void *arrays[3] = { g.offsetArray(), g.targetArray(), g.weightArray() };
+	size_t sizes[3] = { ((size_t)g.numVertices() + 1) * sizeof(int32_t),
+		(size_t)g.numEdges() * sizeof(int32_t), (size_t)g.numEdges() * sizeof(int32_t) };
+	writeCache(fileName, &h, sizeof(h), arrays, sizes, 3);
+}
+
+bool isGraphCache(const mappedFile &file)
+{
+	return hasMagic(file, "LICG");
+}
+
+void loadGraphCache(const string &fileName, const std::shared_ptr<mappedFile> &file,
+	csrGraph &g, int &start, int &end)
+// Make g read the graph cache in file, which must stay mapped while g or a
+// copy of it is in use; g holds on to file for that.  Sets start and end to
+// the graph's start and end vertices.
+{
+	graphCacheHeader h;
+	if (file->size() >= sizeof(h))
+		memcpy(&h, file->data(), sizeof(h));
+	checkCacheHeader(fileName, *file, sizeof(h), h.version);
+
+	size_t want = sizeof(h) + ((size_t)h.numVertices + 1 + 2 * (size_t)h.numEdges) * sizeof(int32_t);
+	if (h.numVertices < 1 || h.numEdges < 0 || file->size() != want)
+		throw fileError(fileName + ": cache size doesn't match its header");
+	if (h.start < 0 || h.start >= h.numVertices || h.end < 0 || h.end >= h.numVertices)
+		throw fileError(fileName + ": cache start or end vertex is not in the graph");
+
+	const int *offsets = (const int *)(file->data() + sizeof(h));
+	const int *targets = offsets + h.numVertices + 1;
+	const int *weights = targets + h.numEdges;
+	if (offsets[0] != 0 || offsets[h.numVertices] != h.numEdges)
+		throw fileError(fileName + ": cache offsets don't match its edge count");
+	for (int v = 0; v < h.numVertices; v++)
+		if (offsets[v + 1] < offsets[v])
+			throw fileError(fileName + ": cache offsets go back at vertex " + to_string(v));
+#if CacheCheckEdges
+	if (h.minWeight > h.maxWeight && h.numEdges > 0)
+		throw fileError(fileName + ": cache weight range is empty");
+	for (int e = 0; e < h.numEdges; e++)
+	{
+		if (targets[e] < 0 || targets[e] >= h.numVertices)
+			throw fileError(fileName + ": cache edge " + to_string(e) + " leads to no vertex");
+		if (weights[e] < h.minWeight || weights[e] > h.maxWeight)
+			throw fileError(fileName + ": cache edge " + to_string(e) +
+				" has a weight outside the header's range");
+	}
+#endif
+
+	g = csrGraph(h.numVertices, h.numEdges, offsets, targets, weights, h.minWeight,
+		h.maxWeight, file);
+	start = h.start;
+	end = h.end;
+}
+
+void saveMazeCache(const string &fileName, int rows, int cols, int wordsPerRow,
+	const uint64_t *bits)
+// Write the open-cell bitmap bits of a rows x cols maze, laid out as
+// maze::bitmap() describes, to fileName as a maze cache.
+{
+	mazeCacheHeader h;
+	memcpy(h.magic, "LICM", 4);
+	h.version = CacheVersion;
+	h.rows = rows;
+	h.cols = cols;
+	h.wordsPerRow = wordsPerRow;
+	h.unused = 0;
+
+	const void *arrays[1] = { bits };
+	size_t sizes[1] = { (size_t)rows * wordsPerRow * sizeof(uint64_t) };
+	writeCache(fileName, &h, sizeof(h), arrays, sizes, 1);
+}
+
+bool isMazeCache(const mappedFile &file)
+{
+	return hasMagic(file, "LICM");
+}
+
+#endif
@@ -0,0 +1,177 @@
+// bitmapBFS.h header file
+//
+// Implements a breadth-first search over a maze's open-cell bitmap that
+// moves 64 cells per operation.
+//
+// The frontier is kept as a bitmap in the same layout as the maze's.  One
+// step of the search spreads each frontier word left and right by shifting
+// it one bit (carrying the end bits into the neighbouring words of the same
+// row) and up and down by ORing it into the rows above and below, then
+// ANDs the result with the open cells not yet visited.  What survives is
+// the next layer.  Only words that hold part of the frontier are touched,
+// so a narrow passage costs a word or two per step while an open room
+// moves 64 cells at a time.
+//
+// Cells in layer k are k moves from the start, so the distance to the
+// goal is the number of the layer it turns up in.  If asked, the search
+// also writes each cell's layer number out as its distance, and a shortest
+// path is found afterwards by walking back from the goal to any neighbour
+// one layer lower.
+
+#ifndef BitmapBFS_h
+#define BitmapBFS_h
+
+#include <algorithm>
+#include <assert.h>
+#include <stdint.h>
+#include <vector>
+
+#include "d_except.h"
+#include "graph.h"
+#include "maze.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+int lowestBit(uint64_t bits)
+// Return the index of the lowest set bit of bits, which must not be 0.
+{
+#ifdef _MSC_VER
+	unsigned long i;
+	_BitScanForward64(&i, bits);
+	return (int)i;
+#else
+	return __builtin_ctzll(bits);
+#endif
+}
+
+int bitmapBFS(const maze &m, pair<int, int> start, pair<int, int> goal,
+	vector<int> *dist = NULL)
+// Return the fewest moves from cell start to cell goal in maze m, or
+// LargeValue if goal can't be reached.  If dist is given, it is filled
+// with the distance of every cell reached, indexed by i * numCols + j, or
+// LargeValue for cells not reached.
+{
+	int rows = m.numRows();
+	int cols = m.numCols();
+	if (start.first < 0 || start.first >= rows || start.second < 0 || start.second >= cols ||
+		goal.first < 0 || goal.first >= rows || goal.second < 0 || goal.second >= cols)
+		throw rangeError("Bad cell in bitmapBFS");
+
+	if (dist != NULL)
+		dist->assign((size_t)rows * cols, LargeValue);
+	if (!m.isOpen(start.first, start.second) || !m.isOpen(goal.first, goal.second))
+		return LargeValue;
+
+	int wpr = m.wordsPerRow();
+	const uint64_t *open = m.bitmap();
+	size_t numWords = (size_t)rows * wpr;
+	size_t goalWord = (size_t)goal.first * wpr + (goal.second >> 6);
+	uint64_t goalBit = (uint64_t)1 << (goal.second & 63);
+
+	// frontier and next layer, with the indices of their nonzero words
+	vector<uint64_t> frontier(numWords, 0), next(numWords, 0), visited(numWords, 0);
+	vector<size_t> active, nextActive;
+
+	size_t w = (size_t)start.first * wpr + (start.second >> 6);
+	frontier[w] = visited[w] = (uint64_t)1 << (start.second & 63);
+	active.push_back(w);
+	if (dist != NULL)
+		(*dist)[(size_t)start.first * cols + start.second] = 0;
+
+	// add the cells in bits that are open and unvisited to word b of the
+	// next layer
+	auto spread = [&](size_t b, uint64_t bits)
+	{
+		bits &= open[b] & ~visited[b];
+		if (bits == 0)
+			return;
+		if (next[b] == 0)
+			nextActive.push_back(b);
+		next[b] |= bits;
+	};
+
+	for (int layer = 0; !active.empty(); layer++)
+	{
+		if (frontier[goalWord] & goalBit)
+			return layer;
+
+		for (size_t a = 0; a < active.size(); a++)
+		{
+			size_t b = active[a];
+			uint64_t f = frontier[b];
+			size_t k = b % wpr;
+
+			// right and left within the word, then across into the
+			// neighbouring words of the row
+			spread(b, (f << 1) | (f >> 1));
+			if (k + 1 < (size_t)wpr)
+				spread(b + 1, f >> 63);
+			if (k > 0)
+				spread(b - 1, f << 63);
+			// up and down
+			if (b >= (size_t)wpr)
+				spread(b - wpr, f);
+			if (b + wpr < numWords)
+				spread(b + wpr, f);
+			frontier[b] = 0;
+		}
+
+		// the next layer is visited at distance layer + 1
+		for (size_t a = 0; a < nextActive.size(); a++)
+		{
+			size_t b = nextActive[a];
+			visited[b] |= next[b];
+			if (dist != NULL)
+			{
+				size_t row = b / wpr;
+				int col0 = (int)(b % wpr) * 64;
+				for (uint64_t bits = next[b]; bits != 0; bits &= bits - 1)
+					(*dist)[row * cols + col0 + lowestBit(bits)] = layer + 1;
+			}
+		}
+		frontier.swap(next);
+		active.swap(nextActive);
+		nextActive.clear();
+	}
+	return LargeValue;
+}
+
+void pathFromLayers(const maze &m, const vector<int> &dist, pair<int, int> start,
+	pair<int, int> goal, vector<pair<int, int> > &path)
+// Fill path with a shortest path of cells from start to goal, using the
+// distances left by bitmapBFS.  Leaves path empty if goal was not reached.
+{
+	int cols = m.numCols();
+	path.clear();
+	int d = dist[(size_t)goal.first * cols + goal.second];
+	if (d == LargeValue)
+		return;
+
+	// step to any neighbour one layer closer to the start
+	const int di[4] = { -1, 0, 0, 1 };
+	const int dj[4] = { 0, -1, 1, 0 };
+	pair<int, int> c = goal;
+	path.push_back(c);
+	for (; d > 0; d--)
+	{
+		for (int k = 0; k < 4; k++)
+		{
+			int i = c.first + di[k], j = c.second + dj[k];
+			if (i >= 0 && i < m.numRows() && j >= 0 && j < cols &&
+				dist[(size_t)i * cols + j] == d - 1)
+			{
+				c = make_pair(i, j);
+				break;
+			}
+		}
+		path.push_back(c);
+	}
+	// layer 0 holds only the start, so the walk can't end anywhere else
+	assert(c == start);
+	(void)start;
+	reverse(path.begin(), path.end());
+}
+
+#endif
@@ -0,0 +1,438 @@
+// bucketQueue.h header file
+//
+// Implements two monotone priority queues for small non-negative integer
+// keys: Dial's bucket queue and a radix heap.
+//
+// Both rely on the property that dijkstra's never inserts a key smaller than
+// the last key it extracted.  Neither compares keys against each other the
+// way a heap does; items are filed into buckets by the value of their key,
+// so the work per operation depends on the range of edge weights rather than
+// on the number of items.  Both have the same interface as dHeap so that
+// dijkstra can be run with any of them.
+
+#ifndef bucketQueue_h
+#define bucketQueue_h
+
+#include "d_except.h"
+#include "solverStats.h"
+#include <limits.h>
+#include <vector>
+
+template <typename T>
+class dialQueue
+// Dial's algorithm queue.  With edge weights in [0, C], every key in the
+// queue lies in [min, min + C], so C + 1 buckets used circularly are enough.
+// Each bucket is a doubly linked list threaded through per-item arrays, so
+// decrease-key unlinks an item in O(1).  Keys too far ahead of the minimum
+// (the "infinite" weights of unreached vertices) wait in an overflow list
+// until the scan comes within reach of them.
+{
+public:
+	struct entry
+	{
+		int key;
+		T item;
+	};
+
+	dialQueue(int maxWeight);
+	~dialQueue() { StatBytes(heapBytes, bytes()); }
+	void initializeMinHeap(vector<entry> &&list2);
+
+	bool contains(T item) { return (size_t)item < where.size() && where[item] != notQueued; }
+	int size() { return count; }
+	bool empty() { return count == 0; }
+	size_t bytes() const
+	{
+		return (head.capacity() + next.capacity() + prev.capacity()) * sizeof(T) +
+			(key.capacity() + where.capacity()) * sizeof(int);
+	}
+
+	T extractMinHeapMinimum();
+	void minHeapDecreaseKey(T item, int key);
+	void minHeapInsert(T item, int key);
+
+private:
+	enum { notQueued = -2, overflow = -1 };
+
+	void link(T item, int key);
+	void unlink(T item);
+	void refill();
+
+	int numBuckets;        // maxWeight + 1
+	int current;           // smallest key that may still be in the queue
+	int count;             // number of items in the queue
+	int overflowCount;     // number of those items in the overflow list
+	int overflowLow;       // no key in the overflow list is below this
+
+	vector<T> head;        // first item in each bucket, or noItem
+	T overflowHead;        // first item in the overflow list, or noItem
+	vector<T> next, prev;  // links of the list each item is in
+	vector<int> key;       // key of each item
+	vector<int> where;     // bucket holding each item, overflow or notQueued
+
+	static const T noItem = (T)-1;
+};
+
+template <typename T>
+const T dialQueue<T>::noItem;
+
+template <typename T>
+dialQueue<T>::dialQueue(int maxWeight)
+// Construct an empty queue for keys whose increments are at most maxWeight.
+	: numBuckets(maxWeight + 1), current(0), count(0), overflowCount(0),
+	overflowLow(INT_MAX), head(maxWeight + 1, noItem), overflowHead(noItem)
+{
+	if (maxWeight < 0)
+		throw rangeError("negative maximum weight in dialQueue");
+}
+
+template <typename T>
+void dialQueue<T>::initializeMinHeap(vector<entry> &&list2)
+// Initialize the queue from the entries in list2.
+{
+	vector<entry> items = std::move(list2);
+
+	T maxItem = 0;
+	current = items.size() > 0 ? items[0].key : 0;
+	for (int i = 0; i < (int)items.size(); i++)
+	{
+		if (items[i].item > maxItem)
+			maxItem = items[i].item;
+		if (items[i].key < current)
+			current = items[i].key;
+	}
+	next.assign(maxItem + 1, noItem);
+	prev.assign(maxItem + 1, noItem);
+	key.assign(maxItem + 1, 0);
+	where.assign(maxItem + 1, notQueued);
+
+	for (int i = 0; i < (int)items.size(); i++)
+		link(items[i].item, items[i].key);
+}
+
+template <typename T>
+void dialQueue<T>::link(T item, int k)
+// Push item on the front of the bucket for key k.
+{
+	key[item] = k;
+	T *first;
+	if (k - current < numBuckets)
+	{
+		where[item] = k % numBuckets;
+		first = &head[where[item]];
+	}
+	else
+	{
+		where[item] = overflow;
+		first = &overflowHead;
+		overflowCount++;
+		if (k < overflowLow)
+			overflowLow = k;
+	}
+
+	prev[item] = noItem;
+	next[item] = *first;
+	if (*first != noItem)
+		prev[*first] = item;
+	*first = item;
+	count++;
+}
+
+template <typename T>
+void dialQueue<T>::unlink(T item)
+// Remove item from the list it is in.
+{
+	if (prev[item] != noItem)
+		next[prev[item]] = next[item];
+	else if (where[item] == overflow)
+		overflowHead = next[item];
+	else
+		head[where[item]] = next[item];
+
+	if (where[item] == overflow)
+		overflowCount--;
+
+	if (next[item] != noItem)
+		prev[next[item]] = prev[item];
+
+	where[item] = notQueued;
+	count--;
+}
+
+template <typename T>
+void dialQueue<T>::refill()
+// Move the overflow items whose keys are now within reach of current into
+// buckets, and recompute the lowest key left behind.
+{
+	int low = INT_MAX;
+	T i = overflowHead;
+	while (i != noItem)
+	{
+		T n = next[i];
+		if (key[i] - current < numBuckets)
+		{
+			unlink(i);
+			link(i, key[i]);
+		}
+		else if (key[i] < low)
+			low = key[i];
+		i = n;
+	}
+	overflowLow = low;
+}
+
+template <typename T>
+T dialQueue<T>::extractMinHeapMinimum()
+// Return the item with the smallest key and remove it.
+{
+	StatCount(extractions);
+	if (count < 1)
+		throw rangeError("queue empty in extractMinHeapMinimum");
+
+	// Scan forward from the current key for a nonempty bucket, pulling in
+	// overflow items as the scan reaches them
+	while (true)
+	{
+		if (overflowCount > 0 && overflowLow - current < numBuckets)
+			refill();
+		if (head[current % numBuckets] != noItem)
+			break;
+		if (count == overflowCount)
+			current = overflowLow;
+		else
+			current++;
+	}
+
+	T min = head[current % numBuckets];
+	unlink(min);
+	return min;
+}
+
+template <typename T>
+void dialQueue<T>::minHeapDecreaseKey(T item, int k)
+// Lower the key of item, which must be in the queue, to k.
+{
+	StatCount(decreaseKeys);
+	if (!contains(item))
+		throw rangeError("item not found in minHeapDecreaseKey");
+	if (k < current)
+		throw rangeError("key below current minimum in dialQueue");
+	unlink(item);
+	link(item, k);
+}
+
+template <typename T>
+void dialQueue<T>::minHeapInsert(T item, int k)
+// Add item to the queue with key k.
+{
+	StatCount(inserts);
+	if ((size_t)item >= where.size())
+	{
+		next.resize(item + 1, noItem);
+		prev.resize(item + 1, noItem);
+		key.resize(item + 1, 0);
+		where.resize(item + 1, notQueued);
+	}
+	// An empty queue can start over from a lower key; a higher one just
+	// leaves the scan to catch up, since a lower key may still follow
+	if (count == 0 && k < current)
+		current = k;
+	if (k < current)
+		throw rangeError("key below current minimum in dialQueue");
+	link(item, k);
+}
+
+template <typename T>
+class radixHeap
+// Radix heap.  Bucket b holds the entries whose key first differs from the
+// last extracted key in bit b - 1 (bucket 0 holds keys equal to it).  When
+// bucket 0 runs dry, the lowest nonempty bucket is redistributed around its
+// smallest key, and every entry moves to a strictly lower bucket, so each
+// entry is touched O(log C) times in total.  Decrease-key pushes a fresh
+// entry and the stale one is skipped when it surfaces.
+{
+public:
+	struct entry
+	{
+		int key;
+		T item;
+	};
+
+	radixHeap();
+	~radixHeap() { StatBytes(heapBytes, bytes()); }
+	void initializeMinHeap(vector<entry> &&list2);
+
+	bool contains(T item) { return (size_t)item < queued.size() && queued[item]; }
+	int size() { return count; }
+	bool empty() { return count == 0; }
+	size_t bytes() const
+	{
+		size_t n = key.capacity() * sizeof(int) + queued.capacity();
+		for (int b = 0; b < numBuckets; b++)
+			n += bucket[b].capacity() * sizeof(entry);
+		return n;
+	}
+
+	T extractMinHeapMinimum();
+	void minHeapDecreaseKey(T item, int key);
+	void minHeapInsert(T item, int key);
+
+private:
+	enum { numBuckets = 33 };
+
+	int bucketFor(int k);
+	void push(T item, int k);
+
+	unsigned last;           // the last key extracted
+	int count;               // number of items in the queue
+
+	vector<entry> bucket[numBuckets];
+	vector<int> key;         // current key of each item
+	vector<char> queued;     // true if the item is in the queue
+};
+
+template <typename T>
+radixHeap<T>::radixHeap()
+// Construct an empty heap.
+	: last(0), count(0)
+{
+}
+
+template <typename T>
+int radixHeap<T>::bucketFor(int k)
+// Return the bucket for key k: one more than the index of the highest bit in
+// which k differs from last.
+{
+	unsigned diff = (unsigned)k ^ last;
+	int b = 0;
+	while (diff != 0)
+	{
+		diff >>= 1;
+		b++;
+	}
+	return b;
+}
+
+template <typename T>
+void radixHeap<T>::push(T item, int k)
+// File an entry for item under key k.
+{
+	key[item] = k;
+	bucket[bucketFor(k)].push_back(entry{ k, item });
+}
+
+template <typename T>
+void radixHeap<T>::initializeMinHeap(vector<entry> &&list2)
+// Initialize the heap from the entries in list2.
+{
+	vector<entry> items = std::move(list2);
+
+	T maxItem = 0;
+	last = items.size() > 0 ? (unsigned)items[0].key : 0;
+	for (int i = 0; i < (int)items.size(); i++)
+	{
+		if (items[i].key < 0)
+			throw rangeError("negative key in radixHeap");
+		if (items[i].item > maxItem)
+			maxItem = items[i].item;
+		if ((unsigned)items[i].key < last)
+			last = items[i].key;
+	}
+	key.assign(maxItem + 1, 0);
+	queued.assign(maxItem + 1, false);
+
+	for (int i = 0; i < (int)items.size(); i++)
+	{
+		queued[items[i].item] = true;
+		push(items[i].item, items[i].key);
+	}
+	count = (int)items.size();
+}
+
+template <typename T>
+T radixHeap<T>::extractMinHeapMinimum()
+// Return the item with the smallest key and remove it.
+{
+	StatCount(extractions);
+	if (count < 1)
+		throw rangeError("heap too small in extractMinHeapMinimum");
+
+	while (true)
+	{
+		// Skip entries that were superseded by a decrease-key
+		while (!bucket[0].empty())
+		{
+			entry e = bucket[0].back();
+			bucket[0].pop_back();
+			if (queued[e.item] && key[e.item] == e.key)
+			{
+				queued[e.item] = false;
+				count--;
+				return e.item;
+			}
+		}
+
+		// Redistribute the lowest nonempty bucket around its smallest live key
+		int b = 1;
+		while (bucket[b].empty())
+			b++;
+
+		vector<entry> moving;
+		moving.swap(bucket[b]);
+		bool found = false;
+		for (int i = 0; i < (int)moving.size(); i++)
+			if (queued[moving[i].item] && key[moving[i].item] == moving[i].key &&
+				(!found || (unsigned)moving[i].key < last))
+			{
+				last = moving[i].key;
+				found = true;
+			}
+		for (int i = 0; i < (int)moving.size(); i++)
+			if (queued[moving[i].item] && key[moving[i].item] == moving[i].key)
+				bucket[bucketFor(moving[i].key)].push_back(moving[i]);
+
+		// Every entry moved lower, so hand the storage back to bucket b
+		moving.clear();
+		moving.swap(bucket[b]);
+	}
+}
+
+template <typename T>
+void radixHeap<T>::minHeapDecreaseKey(T item, int k)
+// Lower the key of item, which must be in the heap, to k.
+{
+	StatCount(decreaseKeys);
+	if (!contains(item))
+		throw rangeError("item not found in minHeapDecreaseKey");
+	if (k < 0 || (unsigned)k < last)
+		throw rangeError("key below current minimum in radixHeap");
+	push(item, k);
+}
+
+template <typename T>
+void radixHeap<T>::minHeapInsert(T item, int k)
+// Add item to the heap with key k.
+{
+	StatCount(inserts);
+	if ((size_t)item >= queued.size())
+	{
+		key.resize(item + 1, 0);
+		queued.resize(item + 1, false);
+	}
+	if (count == 0)
+	{
+		// Only stale entries remain, so they can be dropped, and the heap
+		// can start over from a lower key
+		for (int b = 0; b < numBuckets; b++)
+			bucket[b].clear();
+		if (k >= 0 && (unsigned)k < last)
+			last = k;
+	}
+	if (k < 0 || (unsigned)k < last)
+		throw rangeError("key below current minimum in radixHeap");
+	queued[item] = true;
+	push(item, k);
+	count++;
+}
+
+#endif
@@ -0,0 +1,304 @@
+// csrGraph.h header file
+//
+// Implements an immutable compressed sparse row (CSR) snapshot of a graph.
+//
+// The out edges of vertex u are the entries offsets[u] .. offsets[u + 1] - 1
+// of the targets and weights arrays, so a search walks three contiguous
+// arrays instead of a per-vertex edge vector.  Nothing is stored for in
+// edges or per-edge flags, and the snapshot is never modified after it is
+// built, so any number of searches can read it.
+//
+// The arrays are usually the graph's own, but they can also be borrowed
+// from memory the graph doesn't manage, such as a mapped cache file, and
+// read where they lie.  The graph then holds a shared pointer to whatever
+// keeps that memory alive.
+
+#ifndef CsrGraph_h
+#define CsrGraph_h
+
+#include <limits.h>
+#include <memory>
+#include <vector>
+
+#include "d_except.h"
+#include "graph.h"
+
+class csrGraph
+{
+public:
+	csrGraph();
+	// Construct an empty graph.
+
+	csrGraph(const Graph &g);
+	// Snapshot a Boost graph.  Out edges keep the order Boost lists them in.
+
+	csrGraph(int numVertices, const vector<int> &src, const vector<int> &dst,
+		const vector<int> &w);
+	// Build from an edge list (src[i], dst[i], w[i]).  Out edges of each
+	// vertex keep the order they appear in the list.
+
+	csrGraph(int numVertices, const vector<int> &edges);
+	// Build from a flat edge list holding (source, target, weight) triples
+	// one after another.  Out edges keep the order they appear in.
+
+	csrGraph(vector<int> &&offsets2, vector<int> &&targets2, vector<int> &&weights2,
+		vector<pair<int, int> > &&cells2 = vector<pair<int, int> >());
+	// Take over arrays that are already in CSR form.  cells2 is either empty
+	// or holds the maze cell of each vertex.
+
+	csrGraph(int numVertices, int numEdges, const int *offsets2, const int *targets2,
+		const int *weights2, int minWeight2, int maxWeight2, std::shared_ptr<const void> owner2);
+	// Read arrays in CSR form where they lie, without copying them.  owner2
+	// must keep them alive; the graph and its copies hold on to it.  The
+	// weight range is taken as given.
+
+	csrGraph(const csrGraph &g);
+	csrGraph(csrGraph &&g);
+	csrGraph &operator=(const csrGraph &g);
+	csrGraph &operator=(csrGraph &&g);
+
+	int numVertices() const { return n; }
+	int numEdges() const { return m; }
+
+	int beginEdge(int u) const { return offsetData[u]; }    // index of the first out edge of u
+	int endEdge(int u) const { return offsetData[u + 1]; }  // one past the last out edge of u
+	int target(int e) const { return targetData[e]; }
+	int weight(int e) const { return weightData[e]; }
+
+	const int *offsetArray() const { return offsetData; }   // n + 1 entries
+	const int *targetArray() const { return targetData; }   // numEdges entries
+	const int *weightArray() const { return weightData; }   // numEdges entries
+
+	int minEdgeWeight() const { return minWeight; }
+	int maxEdgeWeight() const { return maxWeight; }
+
+	bool hasCells() const { return !cells.empty(); }
+	const pair<int, int> &cell(int v) const { return cells[v]; }
+
+	csrGraph reversed() const;
+	// Return the graph with every edge turned around, so the out edges of
+	// v in the result are the in edges of v here.
+
+	size_t bytes() const;
+	// Return the number of bytes held by the arrays, borrowed or not.
+
+private:
+	template <typename EdgeAt>
+	void build(int numEdges, EdgeAt edgeAt);
+	void findWeightRange();
+	void attach();
+
+	int n;                        // number of vertices
+	int m;                        // number of edges
+	vector<int> offsets;          // n + 1 entries, unless borrowed
+	vector<int> targets;          // target of each edge, unless borrowed
+	vector<int> weights;          // weight of each edge, unless borrowed
+	vector<pair<int, int> > cells; // maze cell of each vertex, if any
+	const int *offsetData;        // the arrays searches read, which are
+	const int *targetData;        // either the vectors above or borrowed
+	const int *weightData;
+	std::shared_ptr<const void> owner; // keeps borrowed arrays alive, else null
+	int minWeight, maxWeight;     // range of the edge weights
+};
+
+csrGraph::csrGraph()
+	: n(0), offsets(1, 0), minWeight(INT_MAX), maxWeight(INT_MIN)
+{
+	attach();
+}
+
+csrGraph::csrGraph(int numVertices, int numEdges, const int *offsets2, const int *targets2,
+	const int *weights2, int minWeight2, int maxWeight2, std::shared_ptr<const void> owner2)
+	: n(numVertices), m(numEdges), offsetData(offsets2), targetData(targets2),
+	weightData(weights2), owner(owner2), minWeight(minWeight2), maxWeight(maxWeight2)
+{
+	if (!owner)
+		throw rangeError("borrowed arrays need an owner in csrGraph");
+}
+
+csrGraph::csrGraph(const csrGraph &g)
+	: n(g.n), m(g.m), offsets(g.offsets), targets(g.targets), weights(g.weights),
+	cells(g.cells), offsetData(g.offsetData), targetData(g.targetData),
+	weightData(g.weightData), owner(g.owner), minWeight(g.minWeight), maxWeight(g.maxWeight)
+{
+	attach();
+}
+
+csrGraph::csrGraph(csrGraph &&g)
+	: n(g.n), m(g.m), offsets(std::move(g.offsets)), targets(std::move(g.targets)),
+	weights(std::move(g.weights)), cells(std::move(g.cells)), offsetData(g.offsetData),
+	targetData(g.targetData), weightData(g.weightData), owner(std::move(g.owner)),
+	minWeight(g.minWeight), maxWeight(g.maxWeight)
+{
+	attach();
+}
+
+csrGraph &csrGraph::operator=(const csrGraph &g)
+{
+	if (this != &g)
+		*this = csrGraph(g);
+	return *this;
+}
+
+csrGraph &csrGraph::operator=(csrGraph &&g)
+{
+	n = g.n;
+	m = g.m;
+	offsets = std::move(g.offsets);
+	targets = std::move(g.targets);
+	weights = std::move(g.weights);
+	cells = std::move(g.cells);
+	offsetData = g.offsetData;
+	targetData = g.targetData;
+	weightData = g.weightData;
+	owner = std::move(g.owner);
+	minWeight = g.minWeight;
+	maxWeight = g.maxWeight;
+	attach();
+	return *this;
+}
+
+void csrGraph::attach()
+// Point the arrays searches read at the graph's own vectors, unless they
+// are borrowed.
+{
+	if (owner)
+		return;
+	m = (int)targets.size();
+	offsetData = offsets.data();
+	targetData = targets.data();
+	weightData = weights.data();
+}
+
+csrGraph::csrGraph(const Graph &g)
+	: n((int)num_vertices(g))
+{
+	offsets.reserve(n + 1);
+	targets.reserve(num_edges(g));
+	weights.reserve(num_edges(g));
+
+	offsets.push_back(0);
+	for (int u = 0; u < n; u++)
+	{
+		OutEdgeIteratorRange eitR = out_edges(u, g);
+		for (OutEdgeIterator it = eitR.first; it != eitR.second; ++it)
+		{
+			targets.push_back((int)boost::target(*it, g));
+			weights.push_back(g[*it].weight);
+		}
+		offsets.push_back((int)targets.size());
+	}
+
+	cells.reserve(n);
+	for (int u = 0; u < n; u++)
+		cells.push_back(g[u].cell);
+
+	findWeightRange();
+	attach();
+}
+
+csrGraph::csrGraph(int numVertices, const vector<int> &src, const vector<int> &dst,
+	const vector<int> &w)
+	: n(numVertices)
+{
+	build((int)src.size(), [&](int i, int &u, int &v, int &wt)
+	{
+		u = src[i];
+		v = dst[i];
+		wt = w[i];
+	});
+}
+
+csrGraph::csrGraph(int numVertices, const vector<int> &edges)
+	: n(numVertices)
+{
+	build((int)(edges.size() / 3), [&](int i, int &u, int &v, int &wt)
+	{
+		u = edges[3 * i];
+		v = edges[3 * i + 1];
+		wt = edges[3 * i + 2];
+	});
+}
+
+template <typename EdgeAt>
+void csrGraph::build(int numEdges, EdgeAt edgeAt)
+// Fill the arrays from the numEdges edges that edgeAt(i, u, v, w) hands out.
+{
+	m = numEdges;
+	offsets.assign(n + 1, 0);
+	targets.resize(m);
+	weights.resize(m);
+	int u, v, w;
+
+	// Count the out degree of each vertex, then turn the counts into offsets
+	for (int i = 0; i < m; i++)
+	{
+		edgeAt(i, u, v, w);
+		if (u < 0 || u >= n || v < 0 || v >= n)
+			throw rangeError("edge endpoint out of range in csrGraph");
+		offsets[u + 1]++;
+	}
+	for (u = 0; u < n; u++)
+		offsets[u + 1] += offsets[u];
+
+	// Place each edge in its source's slot range, preserving list order
+	vector<int> next(offsets.begin(), offsets.end() - 1);
+	for (int i = 0; i < m; i++)
+	{
+		edgeAt(i, u, v, w);
+		int e = next[u]++;
+		targets[e] = v;
+		weights[e] = w;
+	}
+
+	findWeightRange();
+	attach();
+}
+
+csrGraph::csrGraph(vector<int> &&offsets2, vector<int> &&targets2, vector<int> &&weights2,
+	vector<pair<int, int> > &&cells2)
+	: n((int)offsets2.size() - 1), offsets(std::move(offsets2)), targets(std::move(targets2)),
+	weights(std::move(weights2)), cells(std::move(cells2))
+{
+	if (n < 0 || offsets[n] != (int)targets.size() || targets.size() != weights.size())
+		throw rangeError("inconsistent arrays in csrGraph");
+	findWeightRange();
+	attach();
+}
+
+void csrGraph::findWeightRange()
+// Record the smallest and largest edge weight.
+{
+	minWeight = INT_MAX;
+	maxWeight = INT_MIN;
+	for (int e = 0; e < (int)weights.size(); e++)
+	{
+		if (weights[e] < minWeight)
+			minWeight = weights[e];
+		if (weights[e] > maxWeight)
+			maxWeight = weights[e];
+	}
+}
+
+csrGraph csrGraph::reversed() const
+{
+	vector<int> src(targetData, targetData + m), dst(m);
+	vector<int> w(weightData, weightData + m);
+	for (int u = 0; u < n; u++)
+		for (int e = offsetData[u]; e < offsetData[u + 1]; e++)
+			dst[e] = u;
+
+	csrGraph r(n, src, dst, w);
+	r.cells = cells;
+	return r;
+}
+
+size_t csrGraph::bytes() const
+{
+	if (owner)
+		return (n + 1 + 2 * (size_t)m) * sizeof(int) + cells.capacity() * sizeof(pair<int, int>);
+	return offsets.capacity() * sizeof(int) + targets.capacity() * sizeof(int) +
+		weights.capacity() * sizeof(int) + cells.capacity() * sizeof(pair<int, int>);
+}
+
+#endif
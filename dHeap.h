@@ -0,0 +1,177 @@
+// dHeap.h header file
+//
+// Implements a d-ary min heap used as a priority queue.
+//
+// Unlike heapV, each entry holds its key next to its item, so comparisons
+// never reach back into the graph.  Entries are stored contiguously and the
+// arity D (typically 4 or 8) keeps the tree shallow, so a sift touches a few
+// adjacent cache lines instead of chasing vertex properties.  Items are
+// vertex descriptors and double as indices into a position map, so finding
+// an item for decrease-key is O(1).
+
+#ifndef dHeap_h
+#define dHeap_h
+
+#include "d_except.h"
+#include "solverStats.h"
+#include <vector>
+
+template <typename K, typename T, int D = 4>
+class dHeap
+{
+public:
+	struct entry
+	{
+		K key;
+		T item;
+	};
+
+	dHeap();
+	~dHeap() { StatBytes(heapBytes, bytes()); }
+	void initializeMinHeap(vector<entry> &&list2);
+
+	int parent(int i) { return (i - 1) / D; }   // Given a node in a heap, return the index of the parent
+	int child(int i) { return D * i + 1; }      // Given a node in a heap, return the index of the first child
+
+	bool contains(T item);
+	int size() { return (int)list.size(); }
+	bool empty() { return list.empty(); }
+	size_t bytes() const { return list.capacity() * sizeof(entry) + position.capacity() * sizeof(int); }
+
+	T getMinHeapMinimum() { return list[0].item; }
+	K getMinHeapMinimumKey() { return list[0].key; }
+	T extractMinHeapMinimum();
+
+	void minHeapDecreaseKey(T item, K key);
+	void minHeapInsert(T item, K key);
+
+private:
+	void siftUp(int i);
+	void siftDown(int i);
+
+	vector<entry> list;
+	vector<int> position;  // position[item] is the index of item in list, or -1
+};
+
+template <typename K, typename T, int D>
+dHeap<K, T, D>::dHeap()
+// Construct an empty heap.
+{
+}
+
+template <typename K, typename T, int D>
+void dHeap<K, T, D>::initializeMinHeap(vector<entry> &&list2)
+// Initialize a min heap by taking over the entries in list2.  The heap is
+// built bottom-up in O(n).
+{
+	list = std::move(list2);
+
+	T maxItem = 0;
+	for (int i = 0; i < size(); i++)
+		if (list[i].item > maxItem)
+			maxItem = list[i].item;
+	position.assign(size() > 0 ? maxItem + 1 : 0, -1);
+	for (int i = 0; i < size(); i++)
+		position[list[i].item] = i;
+
+	for (int i = size() > 1 ? parent(size() - 1) : -1; i >= 0; i--)
+		siftDown(i);
+}
+
+template <typename K, typename T, int D>
+bool dHeap<K, T, D>::contains(T item)
+// Return true if item is currently in the heap.
+{
+	return (size_t)item < position.size() && position[item] != -1;
+}
+
+template <typename K, typename T, int D>
+void dHeap<K, T, D>::siftUp(int i)
+// Move the entry at i toward the root until its parent is no larger.  The
+// entry is held aside and parents are shifted down into the hole, so each
+// level costs one move rather than a swap.
+{
+	entry e = list[i];
+	while (i > 0)
+	{
+		int p = parent(i);
+		if (!(e.key < list[p].key))
+			break;
+		list[i] = list[p];
+		position[list[i].item] = i;
+		i = p;
+	}
+	list[i] = e;
+	position[e.item] = i;
+}
+
+template <typename K, typename T, int D>
+void dHeap<K, T, D>::siftDown(int i)
+// Move the entry at i toward the leaves until none of its children is
+// smaller.
+{
+	int n = size();
+	entry e = list[i];
+	while (true)
+	{
+		int first = child(i);
+		if (first >= n)
+			break;
+
+		// Find the smallest of the (up to D) children
+		int last = first + D < n ? first + D : n;
+		int smallest = first;
+		for (int c = first + 1; c < last; c++)
+			if (list[c].key < list[smallest].key)
+				smallest = c;
+
+		if (!(list[smallest].key < e.key))
+			break;
+		list[i] = list[smallest];
+		position[list[i].item] = i;
+		i = smallest;
+	}
+	list[i] = e;
+	position[e.item] = i;
+}
+
+template <typename K, typename T, int D>
+T dHeap<K, T, D>::extractMinHeapMinimum()
+// Return the item with the smallest key and remove it.
+{
+	StatCount(extractions);
+	if (size() < 1)
+		throw rangeError("heap too small in extractMinHeapMinimum");
+	T min = list[0].item;
+	position[min] = -1;
+	list[0] = list.back();
+	list.pop_back();
+	if (size() > 0)
+		siftDown(0);
+	return min;
+}
+
+template <typename K, typename T, int D>
+void dHeap<K, T, D>::minHeapDecreaseKey(T item, K key)
+// Lower the key of item, which must be in the heap, and restore the heap.
+{
+	StatCount(decreaseKeys);
+	if (!contains(item))
+		throw rangeError("item not found in minHeapDecreaseKey");
+	int i = position[item];
+	list[i].key = key;
+	siftUp(i);
+}
+
+template <typename K, typename T, int D>
+void dHeap<K, T, D>::minHeapInsert(T item, K key)
+// Add a new leaf and move it up to its correct location.
+{
+	StatCount(inserts);
+	if ((size_t)item >= position.size())
+		position.resize(item + 1, -1);
+	list.push_back(entry{ key, item });
+	siftUp(size() - 1);
+}
+
+#endif
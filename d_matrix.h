@@ -1,14 +1,84 @@
 #ifndef MATRIX_CLASS
 #define MATRIX_CLASS
 
+#include <assert.h>
 #include <iostream>
+#include <stdint.h>
 #include <vector>
 
 #include "d_except.h"
 
 using namespace std;
 
+// the matrix is stored as one block in row-major order, so element (i,j)
+// is entry i * cols() + j.  how indices are checked is a policy chosen
+// when the matrix type is named:
+//   checkedIndex    every index is checked and a bad one throws
+//                   indexRangeError (the default)
+//   assertIndex     indices are checked by assert, so only in builds
+//                   without NDEBUG
+//   uncheckedIndex  indices are not checked at all
+
+struct checkedIndex
+{
+	static void check(const char *msg, int i, int size)
+	{
+		if (i < 0 || i >= size)
+			throw indexRangeError(msg, i, size);
+	}
+};
+
+struct assertIndex
+{
+	static void check(const char *, int i, int size)
+	{
+		assert(i >= 0 && i < size);
+		(void)i;
+		(void)size;
+	}
+};
+
+struct uncheckedIndex
+{
+	static void check(const char *, int, int)
+	{
+	}
+};
+
 template <typename T>
+struct matrixSpan
+// a run of count elements starting at first, such as one row of a matrix
+{
+	T *first;
+	int count;
+
+	T *begin() const { return first; }
+	T *end() const { return first + count; }
+	int size() const { return count; }
+	T &operator[](int j) const { return first[j]; }
+};
+
+template <typename T, typename Check>
+class matrixRow
+// what matrix::operator[] returns, so that m[i][j] checks j as well as i
+{
+public:
+	matrixRow(T *row, int numCols) : first(row), nCols(numCols) {}
+
+	T &operator[](int j) const
+	{
+		Check::check("matrix: invalid column index", j, nCols);
+		return first[j];
+	}
+
+	operator T *() const { return first; }
+
+private:
+	T *first;
+	int nCols;
+};
+
+template <typename T, typename Check = checkedIndex>
 class matrix
 {
 public:
@@ -17,17 +87,33 @@ public:
 	// Postcondition: create array having numRows x numCols elements
 	// all of whose elements have value initVal
 
-	vector<T>& operator[] (int i);
+	matrixRow<T, Check> operator[] (int i);
 	// index operator.
-	// Precondition: 0 <= i < nRows. a violation of this
-	// precondition throws the indexRangeError exception.
+	// Precondition: 0 <= i < nRows. under checkedIndex a violation of
+	// this precondition throws the indexRangeError exception, and so does
+	// a bad column index in m[i][j].
 	// Postcondition: if the operator is used on the left-hand
-	// side of an assignment statement, an element of row i 
+	// side of an assignment statement, an element of row i
 	// is changed
 
-	const vector<T>& operator[](int i) const;
+	matrixRow<const T, Check> operator[](int i) const;
 	// version for constant objects
 
+	T *row(int i) { return &mat[(size_t)i * nCols]; }
+	const T *row(int i) const { return &mat[(size_t)i * nCols]; }
+	// raw pointer to the first element of row i, with no check on i
+
+	matrixSpan<T> rowSpan(int i) { return { row(i), nCols }; }
+	matrixSpan<const T> rowSpan(int i) const { return { row(i), nCols }; }
+	// row i as a span, with no check on i
+
+	T *data() { return mat.data(); }
+	const T *data() const { return mat.data(); }
+	// the whole matrix, row after row
+
+	size_t bytes() const { return mat.capacity() * sizeof(T); }
+	// bytes held by the elements
+
 	int rows() const;
 	// return number of rows
 	int cols() const;
@@ -36,78 +122,242 @@ public:
 	void resize(int numRows, int numCols);
 	// modify the matrix size.
 	// Postcondition: the matrix has size numRows x numCols.
-	// any new elements are filled with the default value of type T
+	// elements in both the old and new sizes keep their values and any
+	// new elements are filled with the default value of type T
 
 private:
 	int nRows, nCols;
 	// number of rows and columns
 
-	vector<vector<T> > mat;
-	// matrix is implemented as nRows vectors (rows),
-	// each having nCols elements (columns)
+	vector<T> mat;
+	// matrix is implemented as one vector of nRows * nCols elements,
+	// row after row
 };
 
-template <typename T>
-matrix<T>::matrix(int numRows, int numCols, const T& initVal) :
+template <typename T, typename Check>
+matrix<T, Check>::matrix(int numRows, int numCols, const T& initVal) :
 	nRows(numRows), nCols(numCols),
-	mat(numRows, vector<T>(numCols, initVal))
+	mat((size_t)numRows * numCols, initVal)
 {}
 
 // non-constant version. provides general access to matrix
 // elements
-template <typename T>
-vector<T>& matrix<T>::operator[] (int i)
+template <typename T, typename Check>
+matrixRow<T, Check> matrix<T, Check>::operator[] (int i)
 {
-	if (i < 0 || i >= nRows)
-		throw indexRangeError(
-			"matrix: invalid row index", i, nRows);
-
-	return mat[i];
+	Check::check("matrix: invalid row index", i, nRows);
+	return matrixRow<T, Check>(row(i), nCols);
 }
 
 // constant version.  can be used with a constant object.
 // does not allow modification of a matrix element
-template <typename T>
-const vector<T>& matrix<T>::operator[] (int i) const
+template <typename T, typename Check>
+matrixRow<const T, Check> matrix<T, Check>::operator[] (int i) const
 {
-	if (i < 0 || i >= nRows)
-		throw indexRangeError(
-			"matrix: invalid row index", i, nRows);
-
-	return mat[i];
+	Check::check("matrix: invalid row index", i, nRows);
+	return matrixRow<const T, Check>(row(i), nCols);
 }
 
-template <typename T>
-int matrix<T>::rows() const
+template <typename T, typename Check>
+int matrix<T, Check>::rows() const
 {
 	return nRows;
 }
 
-template <typename T>
-int matrix<T>::cols() const
+template <typename T, typename Check>
+int matrix<T, Check>::cols() const
 {
 	return nCols;
 }
 
-template <typename T>
-void matrix<T>::resize(int numRows, int numCols)
+template <typename T, typename Check>
+void matrix<T, Check>::resize(int numRows, int numCols)
 {
-	int i;
-
 	// handle case of no size change with a return
 	if (numRows == nRows && numCols == nCols)
 		return;
 
+	// rows keep their place only if their width is unchanged
+	if (numCols == nCols)
+	{
+		mat.resize((size_t)numRows * numCols);
+		nRows = numRows;
+		return;
+	}
+
+	// otherwise copy the part the two sizes have in common
+	vector<T> old((size_t)numRows * numCols);
+	old.swap(mat);
+	for (int i = 0; i < numRows && i < nRows; i++)
+		for (int j = 0; j < numCols && j < nCols; j++)
+			mat[(size_t)i * numCols + j] = old[(size_t)i * nCols + j];
+
 	// assign the new matrix size
 	nRows = numRows;
 	nCols = numCols;
+}
+
+// matrix<bool> keeps one bit per element.  each row starts on a fresh
+// 64-bit word, so row i is words i * rowWords() through
+// (i + 1) * rowWords() - 1, and column j of a row is bit j % 64 of its
+// word j / 64.  bits past the last column are always 0.
+
+template <typename Check>
+class matrixBitRow
+// what matrix<bool>::operator[] returns
+{
+public:
+	// lets m[i][j] = x set a single bit
+	class reference
+	{
+	public:
+		reference(uint64_t *w, uint64_t b) : word(w), bit(b) {}
+		operator bool() const { return (*word & bit) != 0; }
+		reference &operator=(bool x)
+		{
+			if (x)
+				*word |= bit;
+			else
+				*word &= ~bit;
+			return *this;
+		}
+		reference &operator=(const reference &r) { return *this = (bool)r; }
+
+	private:
+		uint64_t *word;
+		uint64_t bit;
+	};
+
+	matrixBitRow(uint64_t *row, int numCols) : first(row), nCols(numCols) {}
+
+	reference operator[](int j) const
+	{
+		Check::check("matrix: invalid column index", j, nCols);
+		return reference(first + (j >> 6), (uint64_t)1 << (j & 63));
+	}
 
-	// resize to nRows rows
-	mat.resize(nRows);
+private:
+	uint64_t *first;
+	int nCols;
+};
+
+template <typename Check>
+class matrixConstBitRow
+// what matrix<bool>::operator[] returns for constant objects
+{
+public:
+	matrixConstBitRow(const uint64_t *row, int numCols) : first(row), nCols(numCols) {}
+
+	bool operator[](int j) const
+	{
+		Check::check("matrix: invalid column index", j, nCols);
+		return (first[j >> 6] >> (j & 63)) & 1;
+	}
+
+private:
+	const uint64_t *first;
+	int nCols;
+};
+
+template <typename Check>
+class matrix<bool, Check>
+{
+public:
+	matrix(int numRows = 1, int numCols = 1, bool initVal = false);
+	// constructor.
+	// Postcondition: create array having numRows x numCols elements
+	// all of whose elements have value initVal
+
+	matrixBitRow<Check> operator[] (int i);
+	matrixConstBitRow<Check> operator[] (int i) const;
+	// index operators, as for matrix<T>
+
+	bool get(int i, int j) const
+	// value of element (i,j), with no check on i or j
+	{
+		return (bits[(size_t)i * nWords + (j >> 6)] >> (j & 63)) & 1;
+	}
+
+	void set(int i, int j, bool x)
+	// set element (i,j) to x, with no check on i or j
+	{
+		uint64_t bit = (uint64_t)1 << (j & 63);
+		uint64_t &w = bits[(size_t)i * nWords + (j >> 6)];
+		w = x ? w | bit : w & ~bit;
+	}
+
+	uint64_t *row(int i) { return &bits[(size_t)i * nWords]; }
+	const uint64_t *row(int i) const { return &bits[(size_t)i * nWords]; }
+	// raw pointer to the first word of row i, with no check on i
+
+	uint64_t *data() { return bits.data(); }
+	const uint64_t *data() const { return bits.data(); }
+	// all the words, row after row
+
+	int rowWords() const { return nWords; }
+	// number of 64-bit words in each row
+
+	size_t bytes() const { return bits.capacity() * sizeof(uint64_t); }
+
+	int rows() const { return nRows; }
+	int cols() const { return nCols; }
+
+	void resize(int numRows, int numCols);
+	// as for matrix<T>
+
+private:
+	void fill(int i, int fromCol, bool x);
+
+	int nRows, nCols, nWords;
+	vector<uint64_t> bits;
+};
+
+template <typename Check>
+matrix<bool, Check>::matrix(int numRows, int numCols, bool initVal) :
+	nRows(numRows), nCols(numCols), nWords((numCols + 63) / 64),
+	bits((size_t)numRows * ((numCols + 63) / 64), 0)
+{
+	if (initVal)
+		for (int i = 0; i < nRows; i++)
+			fill(i, 0, true);
+}
+
+template <typename Check>
+void matrix<bool, Check>::fill(int i, int fromCol, bool x)
+// set columns fromCol onward of row i to x
+{
+	for (int j = fromCol; j < nCols; j++)
+		set(i, j, x);
+}
+
+template <typename Check>
+matrixBitRow<Check> matrix<bool, Check>::operator[] (int i)
+{
+	Check::check("matrix: invalid row index", i, nRows);
+	return matrixBitRow<Check>(row(i), nCols);
+}
+
+template <typename Check>
+matrixConstBitRow<Check> matrix<bool, Check>::operator[] (int i) const
+{
+	Check::check("matrix: invalid row index", i, nRows);
+	return matrixConstBitRow<Check>(row(i), nCols);
+}
+
+template <typename Check>
+void matrix<bool, Check>::resize(int numRows, int numCols)
+{
+	if (numRows == nRows && numCols == nCols)
+		return;
 
-	// resize each row to have nCols columns
-	for (i = 0; i < nRows; i++)
-		mat[i].resize(nCols);
+	matrix<bool, Check> old(numRows, numCols);
+	old.bits.swap(bits);
+	swap(old.nRows, nRows);
+	swap(old.nCols, nCols);
+	swap(old.nWords, nWords);
+	for (int i = 0; i < nRows && i < old.nRows; i++)
+		for (int j = 0; j < nCols && j < old.nCols; j++)
+			set(i, j, old.get(i, j));
 }
 
-#endif	// MATRIX_CLASS
\ No newline at end of file
+#endif	// MATRIX_CLASS
@@ -0,0 +1,327 @@
+// deltaStepping.h header file
+//
+// Implements delta-stepping, a parallel single source shortest path search
+// for graphs with non-negative weights.
+//
+// Vertices are kept in buckets of width delta by tentative weight.  The
+// lowest nonempty bucket is emptied in rounds: every vertex in it relaxes
+// its light edges (weight <= delta) in parallel, which may refill the same
+// bucket, and once it stays empty the vertices taken from it relax their
+// heavy edges.  delta = 1 on unit weights is a parallel breadth-first
+// search; a very large delta is a parallel Bellman-Ford.
+//
+// Each thread owns a contiguous block of vertices along with their weights,
+// preds and bucket entries.  A relaxation is sent to the owner of its
+// target as a request, and owners apply the requests between barriers, so
+// no two threads ever write the same memory.  Weights are the same as
+// dijkstra's; where two shortest paths tie, the pred may differ.
+//
+// A round with only a few vertices to relax costs less done by one thread
+// than shared out, since sharing costs two barriers and a pass over the
+// requests.  So while a bucket holds fewer than DeltaSteppingSerialFrontier
+// entries, the last thread to reach a barrier relaxes them directly, and
+// the heavy edges of a small bucket likewise, going on from bucket to
+// bucket while the others wait, until a round is big enough to share.
+// The long thin frontiers of a maze are handled this way almost entirely.
+
+#ifndef DeltaStepping_h
+#define DeltaStepping_h
+
+#include <thread>
+#include <vector>
+
+#include "d_except.h"
+#include "csrGraph.h"
+#include "passBarrier.h"
+#include "searchContext.h"
+
+// a round over fewer entries than this is done by one thread
+#define DeltaSteppingSerialFrontier 1024
+
+int chooseDelta(const csrGraph &g)
+// Pick a bucket width from the weight distribution.  For weights spread
+// evenly over [0, C] and average out degree d, a width of about C / d
+// keeps each bucket's light rounds few while leaving work to share out;
+// twice the mean weight stands in for C so a few outliers don't skew it.
+{
+	if (g.numEdges() == 0)
+		return 1;
+	long long total = 0;
+	for (int e = 0; e < g.numEdges(); e++)
+		total += g.weight(e);
+	double meanWeight = (double)total / g.numEdges();
+	double outDegree = (double)g.numEdges() / g.numVertices();
+	return max(1, (int)(2 * meanWeight / outDegree + 0.5));
+}
+
+struct relaxRequest
+{
+	int v;     // vertex to relax
+	int dist;  // weight offered to v
+	int u;     // vertex offering it
+};
+
+bool deltaStepping(const csrGraph &g, int s, searchContext &ctx, int delta = 0, int numThreads = 0)
+// find lowest weight to each node in CSR graph g starting from vertex s,
+// leaving the weights and preds in ctx, with buckets of width delta (0 to
+// choose one from the weights) and numThreads threads (0 for one per core)
+// all nums must be positive
+// returns true if all nodes are accessible from node s
+{
+	int n = g.numVertices();
+	ctx.reset(n, s);
+	if (g.numEdges() > 0 && g.minEdgeWeight() < 0)
+		throw rangeError("negative edge found");
+	if (delta <= 0)
+		delta = chooseDelta(g);
+	if (numThreads <= 0)
+		numThreads = max(1, (int)thread::hardware_concurrency());
+	numThreads = min(numThreads, max(1, n));
+
+	// Every tentative weight lies within delta + maxWeight of the lowest
+	// nonempty bucket, so that many buckets, used circularly, are enough
+	int maxWeight = max(g.maxEdgeWeight(), 0);
+	int numBuckets = maxWeight / delta + 3;
+
+	int block = (n + numThreads - 1) / numThreads;
+	vector<int> &dist = ctx.dist;
+	vector<int> &pred = ctx.pred;
+
+	// bucket[t][b] holds thread t's vertices with weight in bucket b (mod
+	// numBuckets), possibly with stale entries that have since moved on
+	vector<vector<vector<int> > > bucket(numThreads, vector<vector<int> >(numBuckets));
+	// request[t][o] holds requests from thread t for vertices thread o owns
+	vector<vector<vector<relaxRequest> > > request(numThreads, vector<vector<relaxRequest> >(numThreads));
+	// round in which each vertex was last taken from a bucket, and the
+	// bucket it was last counted as settled in
+	vector<int> takenRound(n, -1), settledBucket(n, -1);
+
+	bucket[s / block][0].push_back(s);
+	int current = 0;        // index of the bucket being emptied
+	int round = 0;          // light rounds so far
+	// settled[t] holds the vertices thread t's buckets gave up in the
+	// current bucket, whose heavy edges are relaxed once it is empty
+	vector<vector<int> > settled(numThreads);
+	vector<int> serialFrontier;
+	passBarrier barrier(numThreads);
+
+	// what the threads do next: a light round, the heavy edges of the
+	// current bucket, or nothing, as the search is over
+	enum { lightPhase, heavyPhase, donePhase } phase = lightPhase;
+
+	// true if any thread has entries in the bucket slot for index b
+	auto slotUsed = [&](int b)
+	{
+		for (int t = 0; t < numThreads; t++)
+			if (!bucket[t][b % numBuckets].empty())
+				return true;
+		return false;
+	};
+
+	// true if a round over the entries in the bucket slot for index b, or
+	// over the heavy edges of the settled lists, is small enough for one
+	// thread
+	auto slotSmall = [&](int b)
+	{
+		size_t total = 0;
+		for (int t = 0; t < numThreads; t++)
+			total += bucket[t][b % numBuckets].size();
+		return numThreads == 1 || total < DeltaSteppingSerialFrontier;
+	};
+	auto settledSmall = [&]()
+	{
+		size_t total = 0;
+		for (int t = 0; t < numThreads; t++)
+			total += settled[t].size();
+		return numThreads == 1 || total < DeltaSteppingSerialFrontier;
+	};
+
+	// Move on to the next nonempty bucket; false if there is none
+	auto advance = [&]()
+	{
+		for (int b = current + 1; b <= current + numBuckets; b++)
+			if (slotUsed(b))
+			{
+				current = b;
+				return true;
+			}
+		return false;
+	};
+
+	// Take from bucket slot mine the vertices whose weight still puts them
+	// in the current bucket and that weren't taken this round, adding them
+	// to frontier, and to owner's settled list the first time
+	auto take = [&](vector<int> &mine, int owner, vector<int> &frontier)
+	{
+		for (int i = 0; i < (int)mine.size(); i++)
+		{
+			int v = mine[i];
+			if (dist[v] / delta != current || takenRound[v] == round)
+				continue;
+			takenRound[v] = round;
+			frontier.push_back(v);
+			if (settledBucket[v] != current)
+			{
+				settledBucket[v] = current;
+				settled[owner].push_back(v);
+			}
+		}
+		mine.clear();
+	};
+
+	// Relax the light or heavy out edges of vertices directly, for use
+	// while the other threads wait
+	auto relaxDirect = [&](const vector<int> &from, bool light)
+	{
+		for (int i = 0; i < (int)from.size(); i++)
+		{
+			int u = from[i];
+			for (int e = g.beginEdge(u); e < g.endEdge(u); e++)
+				if ((g.weight(e) <= delta) == light)
+				{
+					int v = g.target(e);
+					int d = dist[u] + g.weight(e);
+					if (d < dist[v])
+					{
+						dist[v] = d;
+						pred[v] = u;
+						bucket[v / block][(d / delta) % numBuckets].push_back(v);
+					}
+				}
+		}
+	};
+
+	// Run rounds on the calling thread alone, while the others wait in the
+	// barrier, until one is big enough to share out or the search is over
+	auto runSerial = [&]()
+	{
+		while (true)
+		{
+			if (slotUsed(current))
+			{
+				if (!slotSmall(current))
+				{
+					phase = lightPhase;
+					return;
+				}
+				serialFrontier.clear();
+				for (int o = 0; o < numThreads; o++)
+					take(bucket[o][current % numBuckets], o, serialFrontier);
+				round++;
+				relaxDirect(serialFrontier, true);
+			}
+			else
+			{
+				// The bucket's weights are final, so relax the heavy edges
+				if (!settledSmall())
+				{
+					phase = heavyPhase;
+					return;
+				}
+				for (int o = 0; o < numThreads; o++)
+				{
+					relaxDirect(settled[o], false);
+					settled[o].clear();
+				}
+				if (!advance())
+				{
+					phase = donePhase;
+					return;
+				}
+			}
+		}
+	};
+
+	auto work = [&](int t)
+	{
+		vector<int> frontier;
+
+		// Apply the requests sent to this thread
+		auto apply = [&]()
+		{
+			for (int from = 0; from < numThreads; from++)
+			{
+				vector<relaxRequest> &in = request[from][t];
+				for (int i = 0; i < (int)in.size(); i++)
+				{
+					const relaxRequest &r = in[i];
+					if (r.dist < dist[r.v])
+					{
+						dist[r.v] = r.dist;
+						pred[r.v] = r.u;
+						bucket[t][(r.dist / delta) % numBuckets].push_back(r.v);
+					}
+				}
+				in.clear();
+			}
+		};
+
+		// Send requests for the light or heavy out edges of vertices
+		auto relaxFrom = [&](const vector<int> &from, bool light)
+		{
+			for (int i = 0; i < (int)from.size(); i++)
+			{
+				int u = from[i];
+				for (int e = g.beginEdge(u); e < g.endEdge(u); e++)
+					if ((g.weight(e) <= delta) == light)
+					{
+						int v = g.target(e);
+						request[t][v / block].push_back({ v, dist[u] + g.weight(e), u });
+					}
+			}
+		};
+
+		barrier.wait(runSerial);
+		while (phase != donePhase)
+		{
+			if (phase == lightPhase)
+			{
+				// A round of light edges from the current bucket, shared out
+				frontier.clear();
+				take(bucket[t][current % numBuckets], t, frontier);
+				relaxFrom(frontier, true);
+				barrier.wait([]() {});
+				apply();
+				barrier.wait([&]()
+				{
+					round++;
+					runSerial();
+				});
+			}
+			else
+			{
+				// The heavy edges of the emptied bucket, shared out
+				relaxFrom(settled[t], false);
+				settled[t].clear();
+				barrier.wait([]() {});
+				apply();
+				barrier.wait([&]()
+				{
+					if (advance())
+						runSerial();
+					else
+						phase = donePhase;
+				});
+			}
+		}
+	};
+
+	vector<thread> workers;
+	for (int t = 1; t < numThreads; t++)
+		workers.push_back(thread(work, t));
+	work(0);
+	for (int t = 0; t < (int)workers.size(); t++)
+		workers[t].join();
+
+	// see if any node has not been reached by the algorithm
+	bool all = true;
+	for (int v = 0; v < n; v++)
+	{
+		ctx.settled[v] = dist[v] != LargeValue;
+		if (dist[v] == LargeValue)
+			all = false;
+	}
+	return all;
+}
+
+#endif
@@ -0,0 +1,148 @@
+// generate.cpp
+//
+// Writes a generated graph or maze to a file, for testing at sizes beyond
+// the bundled inputs.
+//
+//   generate random -n vertices [-degree d] [options] file
+//   generate grid -rows r -cols c [-keep p] [options] file
+//   generate maze -rows r -cols c [-braid p] [-seed s] [-bin] file
+//
+// random is a sparse graph with about d out edges per vertex (default 4)
+// in which every vertex can be reached.  grid is a road-like grid whose
+// neighbouring vertices are joined both ways with probability p (default
+// 1).  maze is a perfect maze, with odd sizes, in which a fraction p of
+// the dead ends (default 0) are knocked through to braid it.
+//
+// The graph options are
+//   -minw w, -maxw w   range of the edge weights (default 1 to 100)
+//   -negcycle k        plant a negative cycle of k vertices reachable
+//                      from the start
+//   -unreachable       remove the edges into the end vertex
+// and for all three
+//   -seed s            the same seed always gives the same file (default 1)
+//   -bin               write a binary cache instead of text
+//
+// See generators.h for how each is made.
+
+#include <iostream>
+#include <limits.h>
+#include <stdlib.h>
+#include <string>
+
+#include "d_except.h"
+#include "generators.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3)
+	{
+		cerr << "usage: generate random|grid|maze [options] file" << endl;
+		return 1;
+	}
+	string kind = argv[1];
+	string fileName = argv[argc - 1];
+
+	long long n = 0, rows = 0, cols = 0;
+	double degree = 4, keep = 1, braid = 0;
+	int minWeight = 1, maxWeight = 100, cycle = 0;
+	bool unreachable = false, binary = false;
+	uint64_t seed = 1;
+
+	for (int a = 2; a < argc - 1; a++)
+	{
+		string option = argv[a];
+		if (option == "-unreachable")
+			unreachable = true;
+		else if (option == "-bin")
+			binary = true;
+		else if (a + 1 < argc - 1)
+		{
+			const char *value = argv[++a];
+			if (option == "-n")
+				n = atoll(value);
+			else if (option == "-rows")
+				rows = atoll(value);
+			else if (option == "-cols")
+				cols = atoll(value);
+			else if (option == "-degree")
+				degree = atof(value);
+			else if (option == "-keep")
+				keep = atof(value);
+			else if (option == "-braid")
+				braid = atof(value);
+			else if (option == "-minw")
+				minWeight = atoi(value);
+			else if (option == "-maxw")
+				maxWeight = atoi(value);
+			else if (option == "-negcycle")
+				cycle = atoi(value);
+			else if (option == "-seed")
+				seed = strtoull(value, NULL, 10);
+			else
+			{
+				cerr << "bad option " << option << endl;
+				return 1;
+			}
+		}
+		else
+		{
+			cerr << "option " << option << " needs a value" << endl;
+			return 1;
+		}
+	}
+
+	try
+	{
+		seededRandom rnd(seed);
+		if (kind == "maze")
+		{
+			if (rows * cols > INT_MAX)
+				throw rangeError("maze is too large");
+			matrix<bool> open;
+			perfectMaze(open, (int)rows, (int)cols, rnd);
+			if (braid > 0)
+				braidMaze(open, braid, rnd);
+			if (binary)
+				saveGeneratedMaze(fileName, open);
+			else
+				writeMazeText(fileName, open);
+			return 0;
+		}
+
+		generatedGraph g;
+		if (kind == "random")
+		{
+			if (n > INT_MAX || n * degree > INT_MAX)
+				throw rangeError("graph is too large");
+			randomGraph(g, (int)n, degree, minWeight, maxWeight, rnd);
+		}
+		else if (kind == "grid")
+		{
+			if (rows * cols > INT_MAX / 4)
+				throw rangeError("graph is too large");
+			gridGraph(g, (int)rows, (int)cols, keep, minWeight, maxWeight, rnd);
+		}
+		else
+		{
+			cerr << "unknown kind " << kind << ", expected random, grid or maze" << endl;
+			return 1;
+		}
+		if (unreachable)
+			cutOffEnd(g);
+		if (cycle > 0)
+			plantNegativeCycle(g, cycle, minWeight, maxWeight, rnd);
+
+		if (binary)
+			saveGeneratedGraph(fileName, g);
+		else
+			writeGraphText(fileName, g);
+	}
+	catch (baseException e)
+	{
+		cerr << e.what() << endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,368 @@
+// generators.h header file
+//
+// Makes graphs and mazes of any size for testing, the same every time for
+// the same seed.
+//
+// The random numbers come from splitmix64 rather than <random>, whose
+// distributions are allowed to differ from one standard library to the
+// next, so a seed gives the same input on every compiler.
+//
+// A generated graph is a list of (source, target, weight) triples, as
+// loadGraph lays them out, plus its vertex count and start and end
+// vertices.  It can be written as a graphX.txt file or as a graph cache.
+// A generated maze is a matrix<bool> of open cells, whose rows are packed
+// the way a maze's bitmap is, so it can be written as a maze text file or
+// straight out as a maze cache.
+//
+// Mazes follow the layout of the bundled ones: the cells with two even
+// coordinates are rooms, which are always open; the cells between two
+// rooms are the walls that get knocked through; the cells with two odd
+// coordinates are always closed.  Their sizes are odd, so the top left and
+// bottom right cells are rooms.
+
+#ifndef Generators_h
+#define Generators_h
+
+#include <algorithm>
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "d_except.h"
+#include "d_matrix.h"
+#include "csrGraph.h"
+#include "binaryCache.h"
+
+class seededRandom
+{
+public:
+	seededRandom(uint64_t seed) : state(seed) {}
+
+	uint64_t next()
+	// The next 64 random bits.
+	{
+		uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	int below(int n)
+	// A number from 0 to n - 1, for n > 0.
+	{
+		return (int)(((next() >> 32) * (uint64_t)n) >> 32);
+	}
+
+	int between(int lo, int hi)
+	// A number from lo to hi.
+	{
+		return lo + (int)(((next() >> 32) * ((uint64_t)hi - lo + 1)) >> 32);
+	}
+
+	bool chance(double p)
+	// true with probability p.
+	{
+		return (next() >> 11) * (1.0 / 9007199254740992.0) < p;
+	}
+
+private:
+	uint64_t state;
+};
+
+struct generatedGraph
+{
+	int numVertices;
+	int start;
+	int end;
+	vector<int> edges;   // (source, target, weight) triples
+
+	void addEdge(int u, int v, int w)
+	{
+		edges.push_back(u);
+		edges.push_back(v);
+		edges.push_back(w);
+	}
+};
+
+void randomGraph(generatedGraph &g, int n, double degree, int minWeight, int maxWeight,
+	seededRandom &rnd)
+// Make g a random sparse graph of n vertices with about degree out edges
+// per vertex, from start vertex 0 to end vertex n - 1.  The first n - 1
+// edges form a path through every vertex in a random order, starting at
+// 0, so every vertex can be reached; the rest join random pairs.
+{
+	if (n < 2 || degree < 1 || minWeight > maxWeight)
+		throw rangeError("randomGraph needs n >= 2, degree >= 1 and minWeight <= maxWeight");
+	g.numVertices = n;
+	g.start = 0;
+	g.end = n - 1;
+	g.edges.clear();
+	long long m = (long long)(n * degree);
+	g.edges.reserve(3 * (size_t)m);
+
+	// a random order of the vertices after 0
+	vector<int> order(n);
+	for (int v = 0; v < n; v++)
+		order[v] = v;
+	for (int k = n - 1; k > 1; k--)
+		swap(order[k], order[1 + rnd.below(k)]);
+	for (int k = 0; k + 1 < n; k++)
+		g.addEdge(order[k], order[k + 1], rnd.between(minWeight, maxWeight));
+
+	for (long long k = n - 1; k < m; k++)
+		g.addEdge(rnd.below(n), rnd.below(n), rnd.between(minWeight, maxWeight));
+}
+
+void gridGraph(generatedGraph &g, int rows, int cols, double keep, int minWeight,
+	int maxWeight, seededRandom &rnd)
+// Make g a road-like grid of rows x cols vertices, vertex i * cols + j
+// for row i and column j, from the top left corner to the bottom right
+// one.  Each pair of neighbours is joined with probability keep, by edges
+// both ways with the same weight.
+{
+	if (rows < 1 || cols < 1 || (long long)rows * cols < 2 || minWeight > maxWeight)
+		throw rangeError("gridGraph needs at least two vertices and minWeight <= maxWeight");
+	g.numVertices = rows * cols;
+	g.start = 0;
+	g.end = rows * cols - 1;
+	g.edges.clear();
+	g.edges.reserve(12 * (size_t)g.numVertices);
+
+	for (int i = 0; i < rows; i++)
+		for (int j = 0; j < cols; j++)
+		{
+			int v = i * cols + j;
+			if (j + 1 < cols && rnd.chance(keep))
+			{
+				int w = rnd.between(minWeight, maxWeight);
+				g.addEdge(v, v + 1, w);
+				g.addEdge(v + 1, v, w);
+			}
+			if (i + 1 < rows && rnd.chance(keep))
+			{
+				int w = rnd.between(minWeight, maxWeight);
+				g.addEdge(v, v + cols, w);
+				g.addEdge(v + cols, v, w);
+			}
+		}
+}
+
+void cutOffEnd(generatedGraph &g)
+// Remove every edge into g's end vertex, so it can't be reached from the
+// start.
+{
+	size_t kept = 0;
+	for (size_t k = 0; k < g.edges.size(); k += 3)
+		if (g.edges[k + 1] != g.end)
+		{
+			copy(g.edges.begin() + k, g.edges.begin() + k + 3, g.edges.begin() + kept);
+			kept += 3;
+		}
+	g.edges.resize(kept);
+}
+
+void plantNegativeCycle(generatedGraph &g, int length, int minWeight, int maxWeight,
+	seededRandom &rnd)
+// Add a cycle of length vertices to g whose weights add up to -1, and an
+// edge to it from the start vertex.  The end vertex is kept off the cycle,
+// so cutOffEnd can be used before or after.
+{
+	if (length < 1 || length > g.numVertices - 1)
+		throw rangeError("plantNegativeCycle needs a length from 1 to numVertices - 1");
+
+	// length distinct vertices other than the end, chosen at random
+	vector<bool> taken(g.numVertices, false);
+	taken[g.end] = true;
+	vector<int> pool;
+	while ((int)pool.size() < length)
+	{
+		int v = rnd.below(g.numVertices);
+		if (!taken[v])
+		{
+			taken[v] = true;
+			pool.push_back(v);
+		}
+	}
+
+	long long total = 0;
+	for (int k = 0; k + 1 < length; k++)
+	{
+		int w = rnd.between(max(minWeight, 0), max(maxWeight, 0));
+		g.addEdge(pool[k], pool[k + 1], w);
+		total += w;
+	}
+	g.addEdge(pool[length - 1], pool[0], (int)(-total - 1));
+	g.addEdge(g.start, pool[0], rnd.between(max(minWeight, 0), max(maxWeight, 0)));
+}
+
+void perfectMaze(matrix<bool> &open, int rows, int cols, seededRandom &rnd)
+// Make open a rows x cols maze, both odd, in which there is exactly one
+// path between any two rooms.  Rooms are joined by a depth first walk
+// that knocks through to a random unvisited neighbour and backs up when
+// there is none, which gives long winding corridors.
+{
+	if (rows < 1 || cols < 1 || rows % 2 == 0 || cols % 2 == 0)
+		throw rangeError("maze sizes must be odd");
+	open = matrix<bool>(rows, cols);
+
+	// rooms are numbered across the rows of rooms
+	int roomCols = (cols + 1) / 2;
+	const int di[4] = { -2, 0, 0, 2 };
+	const int dj[4] = { 0, -2, 2, 0 };
+
+	vector<int> trail(1, 0);
+	open.set(0, 0, true);
+	while (!trail.empty())
+	{
+		int i = trail.back() / roomCols * 2;
+		int j = trail.back() % roomCols * 2;
+
+		int choices[4], count = 0;
+		for (int k = 0; k < 4; k++)
+		{
+			int ni = i + di[k], nj = j + dj[k];
+			if (ni >= 0 && ni < rows && nj >= 0 && nj < cols && !open.get(ni, nj))
+				choices[count++] = k;
+		}
+		if (count == 0)
+		{
+			trail.pop_back();
+			continue;
+		}
+		int k = choices[rnd.below(count)];
+		int ni = i + di[k], nj = j + dj[k];
+		open.set(i + di[k] / 2, j + dj[k] / 2, true);
+		open.set(ni, nj, true);
+		trail.push_back(ni / 2 * roomCols + nj / 2);
+	}
+}
+
+void braidMaze(matrix<bool> &open, double braid, seededRandom &rnd)
+// Knock a dead end of maze open through to a neighbouring room with
+// probability braid for each dead end, which adds loops and so more than
+// one way between rooms.  braid = 1 leaves no dead ends.
+{
+	int rows = open.rows(), cols = open.cols();
+	const int di[4] = { -1, 0, 0, 1 };
+	const int dj[4] = { 0, -1, 1, 0 };
+
+	for (int i = 0; i < rows; i += 2)
+		for (int j = 0; j < cols; j += 2)
+		{
+			// the walls around the room that are closed but lead to a room
+			int closed[4], count = 0, passages = 0;
+			for (int k = 0; k < 4; k++)
+			{
+				int wi = i + di[k], wj = j + dj[k];
+				if (wi < 0 || wi >= rows || wj < 0 || wj >= cols)
+					continue;
+				if (open.get(wi, wj))
+					passages++;
+				else if (i + 2 * di[k] >= 0 && i + 2 * di[k] < rows &&
+					j + 2 * dj[k] >= 0 && j + 2 * dj[k] < cols)
+					closed[count++] = k;
+			}
+			if (passages == 1 && count > 0 && rnd.chance(braid))
+			{
+				int k = closed[rnd.below(count)];
+				open.set(i + di[k], j + dj[k], true);
+			}
+		}
+}
+
+void appendInt(string &out, long long value)
+// Append value in decimal to out.
+{
+	char digits[24];
+	int n = 0;
+	unsigned long long v = value < 0 ? -(unsigned long long)value : value;
+	do
+	{
+		digits[n++] = (char)('0' + v % 10);
+		v /= 10;
+	} while (v != 0);
+	if (value < 0)
+		out += '-';
+	while (n > 0)
+		out += digits[--n];
+}
+
+// text is written out whenever this much has built up
+#define GeneratorWriteBytes (1 << 20)
+
+void writeGraphText(const string &fileName, const generatedGraph &g)
+// Write g to fileName in the graphX.txt format loadGraph reads.
+{
+	ofstream out(fileName.c_str(), ios::binary | ios::trunc);
+	if (!out)
+		throw fileOpenError(fileName);
+
+	string text;
+	appendInt(text, g.numVertices);
+	text += '\n';
+	appendInt(text, g.start);
+	text += '\n';
+	appendInt(text, g.end);
+	for (size_t k = 0; k < g.edges.size(); k += 3)
+	{
+		text += '\n';
+		appendInt(text, g.edges[k]);
+		text += ' ';
+		appendInt(text, g.edges[k + 1]);
+		text += ' ';
+		appendInt(text, g.edges[k + 2]);
+		if (text.size() >= GeneratorWriteBytes)
+		{
+			out.write(text.data(), text.size());
+			text.clear();
+		}
+	}
+	text += ".\n";
+	out.write(text.data(), text.size());
+	if (!out)
+		throw fileOpenError(fileName);
+}
+
+void saveGeneratedGraph(const string &fileName, const generatedGraph &g)
+// Write g to fileName as a graph cache.
+{
+	saveGraphCache(fileName, csrGraph(g.numVertices, g.edges), g.start, g.end);
+}
+
+void writeMazeText(const string &fileName, const matrix<bool> &open)
+// Write the maze open to fileName in the format maze(const string &)
+// reads.
+{
+	ofstream out(fileName.c_str(), ios::binary | ios::trunc);
+	if (!out)
+		throw fileOpenError(fileName);
+
+	string text;
+	appendInt(text, open.rows());
+	text += '\n';
+	appendInt(text, open.cols());
+	text += '\n';
+	for (int i = 0; i < open.rows(); i++)
+	{
+		for (int j = 0; j < open.cols(); j++)
+			text += open.get(i, j) ? 'O' : 'X';
+		text += '\n';
+		if (text.size() >= GeneratorWriteBytes)
+		{
+			out.write(text.data(), text.size());
+			text.clear();
+		}
+	}
+	out.write(text.data(), text.size());
+	if (!out)
+		throw fileOpenError(fileName);
+}
+
+void saveGeneratedMaze(const string &fileName, const matrix<bool> &open)
+// Write the maze open to fileName as a maze cache.
+{
+	saveMazeCache(fileName, open.rows(), open.cols(), open.rowWords(), open.data());
+}
+
+#endif
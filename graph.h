@@ -0,0 +1,78 @@
+// graph.h header file
+//
+// Boost graph types shared by the graph and maze code.
+
+#ifndef Graph_h
+#define Graph_h
+
+#include <limits.h>
+#include <utility>
+
+#include <boost/graph/adjacency_list.hpp>
+
+using namespace boost;
+using namespace std;
+
+#define LargeValue 99999999
+
+struct VertexProperties;
+struct EdgeProperties;
+struct GraphProperties;
+
+typedef adjacency_list<vecS, vecS, bidirectionalS, VertexProperties, EdgeProperties, GraphProperties> Graph;
+typedef Graph::vertex_descriptor Vertex;
+typedef pair<Graph::edge_descriptor, bool> Edge;
+
+struct VertexProperties
+{
+	pair<int, int> cell; // maze cell (x,y) value
+	Graph::vertex_descriptor pred; // predecessor node
+	int weight;
+	bool visited;
+	bool marked;
+};
+
+// Create a struct to hold properties for each edge
+struct EdgeProperties
+{
+	int weight;
+	bool visited;
+	bool marked;
+};
+
+// Properties of the graph as a whole
+struct GraphProperties
+{
+	// range of the edge weights, recorded when the graph is built
+	// the defaults mean the range is unknown
+	int minEdgeWeight = INT_MIN;
+	int maxEdgeWeight = INT_MAX;
+};
+
+// typedefs for graph elements
+typedef pair<Graph::vertex_iterator, Graph::vertex_iterator> NodeIteratorRange;
+typedef Graph::vertex_iterator NodeIterator;
+
+typedef pair<Graph::edge_iterator, Graph::edge_iterator> EdgeIteratorRange;
+typedef Graph::edge_iterator EdgeIterator;
+
+typedef pair<Graph::adjacency_iterator, Graph::adjacency_iterator> AdjIteratorRange;
+typedef Graph::adjacency_iterator AdjIterator;
+
+typedef pair<Graph::out_edge_iterator, Graph::out_edge_iterator> OutEdgeIteratorRange;
+typedef Graph::out_edge_iterator OutEdgeIterator;
+
+size_t graphBytes(const Graph &g)
+// Estimate the bytes held by g.  Each vertex keeps its properties and a
+// vector each of out and in edges; each edge is a node of the graph's
+// edge list, holding its ends and properties, plus an entry in each of
+// those vectors holding the other end and a pointer to the node.  Spare
+// vector capacity is not counted.
+{
+	size_t perVertex = sizeof(VertexProperties) + 2 * sizeof(vector<void *>);
+	size_t perEdge = 2 * sizeof(void *) + 2 * sizeof(Vertex) + sizeof(EdgeProperties) +
+		2 * (sizeof(Vertex) + sizeof(void *));
+	return num_vertices(g) * perVertex + num_edges(g) * perEdge;
+}
+
+#endif
@@ -0,0 +1,238 @@
+// graphLoader.h header file
+//
+// Reads a graphX.txt file straight into a csrGraph.
+//
+// The file holds the number of vertices, the start vertex and the end
+// vertex, then one "source target weight" edge per line, with a '.' after
+// the last weight.  The file is mapped into memory and its numbers are
+// converted in place, without going through a stream.  The edge section
+// can be split into chunks at whitespace and the chunks converted on
+// several threads; every chunk's numbers are then laid end to end as
+// (source, target, weight) triples, which the csrGraph places with one
+// counting pass.
+//
+// Anything that isn't a number where a number should be, a vertex outside
+// the graph or an edge cut short raises fileError, naming the file and the
+// line the problem is on.
+//
+// A graph cache written by saveGraphCache is recognised by its first bytes
+// and read in place instead.
+
+#ifndef GraphLoader_h
+#define GraphLoader_h
+
+#include <algorithm>
+#include <limits.h>
+#include <string.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <charconv>
+#define GraphLoaderFromChars
+#endif
+
+#include "d_except.h"
+#include "csrGraph.h"
+#include "mappedFile.h"
+#include "binaryCache.h"
+#include "solverStats.h"
+
+// edge sections smaller than this are always read on one thread
+#define GraphLoaderChunkBytes (1 << 20)
+
+bool isBlank(char c)
+// Return true for the characters that separate numbers: spaces, tabs,
+// line ends and other control characters.
+{
+	return (unsigned char)c <= ' ';
+}
+
+const char *parseNumber(const char *p, const char *end, int &value, bool &tooBig)
+// Convert the integer starting at p, which ends before end.  Returns the
+// character after it, or p if there is no integer there.  Sets tooBig if
+// it doesn't fit in an int.
+{
+	tooBig = false;
+#ifdef GraphLoaderFromChars
+	from_chars_result r = from_chars(p, end, value);
+	if (r.ec == errc::result_out_of_range)
+		tooBig = true;
+	return r.ptr;
+#else
+	const char *q = p;
+	bool negative = q < end && *q == '-';
+	if (negative)
+		q++;
+	const char *digits = q;
+	long long v = 0;
+	for (; q < end && *q >= '0' && *q <= '9'; q++)
+		if ((v = v * 10 + (*q - '0')) > (long long)INT_MAX + 1)
+			tooBig = true;
+	if (q == digits)
+		return p;
+	v = negative ? -v : v;
+	if (v > INT_MAX)
+		tooBig = true;
+	value = (int)v;
+	return q;
+#endif
+}
+
+struct parseError
+// Where a chunk's numbers stopped making sense, and why.
+{
+	const char *at;   // NULL if there was no problem
+	string msg;
+};
+
+void parseNumbers(const char *p, const char *end, vector<int> &nums, parseError &err)
+// Append the whitespace separated integers in [p, end) to nums, stopping
+// at the first thing that isn't one.
+{
+	err.at = NULL;
+	while (true)
+	{
+		while (p < end && isBlank(*p))
+			p++;
+		if (p == end)
+			return;
+		int value;
+		bool tooBig;
+		const char *next = parseNumber(p, end, value, tooBig);
+		if (next == p || (next < end && !isBlank(*next)))
+		{
+			err.at = p;
+			err.msg = "expected a number, found '" + string(p, find_if(p, end, isBlank)) + "'";
+			return;
+		}
+		if (tooBig)
+		{
+			err.at = p;
+			err.msg = "number " + string(p, next) + " is too large";
+			return;
+		}
+		nums.push_back(value);
+		p = next;
+	}
+}
+
+void loadGraph(const string &fileName, csrGraph &g, int &start, int &end, int numThreads = 1)
+// Read the graph in fileName into g, and set start and end to its start
+// and end vertices.  The edges are read on numThreads threads, or one per
+// core if numThreads is 0.  Throws fileOpenError if the file can't be
+// opened and fileError if it isn't a valid graph file.
+{
+	std::shared_ptr<mappedFile> file = std::make_shared<mappedFile>(fileName);
+	if (isGraphCache(*file))
+	{
+		loadGraphCache(fileName, file, g, start, end);
+		return;
+	}
+
+	const char *text = file->data();
+	const char *p = text;
+	const char *last = text + file->size();
+
+	auto fail = [&](const char *at, const string &msg)
+	{
+		ostringstream err;
+		err << fileName << " line " << 1 + count(text, at, '\n') << ": " << msg;
+		throw fileError(err.str());
+	};
+
+	// the header: number of vertices, start vertex, end vertex
+	int header[3];
+	const char *names[3] = { "the number of vertices", "the start vertex", "the end vertex" };
+	for (int k = 0; k < 3; k++)
+	{
+		while (p < last && isBlank(*p))
+			p++;
+		bool tooBig;
+		const char *next = parseNumber(p, last, header[k], tooBig);
+		if (next == p || tooBig)
+			fail(p, string("expected ") + names[k]);
+		p = next;
+	}
+	int n = header[0];
+	start = header[1];
+	end = header[2];
+	if (n < 1)
+		fail(p, "a graph needs at least one vertex");
+	if (start < 0 || start >= n || end < 0 || end >= n)
+	{
+		ostringstream msg;
+		msg << "start " << start << " and end " << end << " must be vertices 0 to " << n - 1;
+		fail(p, msg.str());
+	}
+
+	// the edges run up to the '.', or to the end of the file if there is none
+	const char *stop = (const char *)memchr(p, '.', last - p);
+	if (stop == NULL)
+		stop = last;
+
+	// split the edges into chunks, each ending just before whitespace
+	if (numThreads <= 0)
+		numThreads = max(1, (int)thread::hardware_concurrency());
+	numThreads = max(1, min(numThreads, (int)((stop - p) / GraphLoaderChunkBytes)));
+	vector<const char *> bound(numThreads + 1, stop);
+	bound[0] = p;
+	for (int t = 1; t < numThreads; t++)
+	{
+		const char *b = max(bound[t - 1], p + (stop - p) * t / numThreads);
+		while (b < stop && !isBlank(*b))
+			b++;
+		bound[t] = b;
+	}
+
+	// an edge line is about a dozen characters
+	vector<vector<int> > nums(numThreads);
+	vector<parseError> errors(numThreads);
+	auto work = [&](int t)
+	{
+		nums[t].reserve((bound[t + 1] - bound[t]) / 4);
+		parseNumbers(bound[t], bound[t + 1], nums[t], errors[t]);
+	};
+	vector<thread> workers;
+	for (int t = 1; t < numThreads; t++)
+		workers.push_back(thread(work, t));
+	work(0);
+	for (int t = 0; t < (int)workers.size(); t++)
+		workers[t].join();
+
+	for (int t = 0; t < numThreads; t++)
+		if (errors[t].at != NULL)
+			fail(errors[t].at, errors[t].msg);
+
+	// lay the chunks end to end
+	vector<int> edges(std::move(nums[0]));
+	for (int t = 1; t < numThreads; t++)
+		edges.insert(edges.end(), nums[t].begin(), nums[t].end());
+	if (edges.size() % 3 != 0)
+		fail(stop, "the last edge needs a source, a target and a weight");
+
+	for (size_t i = 0; i < edges.size(); i++)
+		if (i % 3 != 2 && (edges[i] < 0 || edges[i] >= n))
+		{
+			// find the bad number again to say where it is
+			const char *q = p;
+			for (size_t k = 0; k <= i; k++)
+			{
+				while (isBlank(*q))
+					q++;
+				if (k < i)
+					while (!isBlank(*q))
+						q++;
+			}
+			ostringstream msg;
+			msg << "vertex " << edges[i] << " is not in the graph, which has vertices 0 to " << n - 1;
+			fail(q, msg.str());
+		}
+
+	g = csrGraph(n, edges);
+	StatBytes(csrGraphBytes, g.bytes());
+}
+
+#endif
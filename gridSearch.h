@@ -0,0 +1,209 @@
+// gridSearch.h header file
+//
+// Implements breadth-first search, dijkstra's and A* directly on the cells
+// of a maze, with no graph built in between.
+//
+// The cell (i, j) of a maze is vertex i * numCols + j, and its neighbours
+// are the open cells above, left, right and below it, worked out when they
+// are needed from the maze's own open-cell bitmap.  The only storage per
+// cell is that bit plus the searchContext's weight, pred and settled
+// entries, where a graph built by mapMazeToGraph costs a Boost vertex and
+// up to four edges with their properties.  Every move costs 1.
+
+#ifndef GridSearch_h
+#define GridSearch_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "d_except.h"
+#include "bucketQueue.h"
+#include "dHeap.h"
+#include "maze.h"
+#include "searchContext.h"
+#include "aStar.h"
+
+class gridView
+// The open cells of a maze as an implicit graph.  It reads the maze's
+// bitmap in place, so the maze must outlive it.
+{
+public:
+	gridView(const maze &m);
+
+	int numRows() const { return rows; }
+	int numCols() const { return cols; }
+	int numVertices() const { return rows * cols; }
+
+	int index(int i, int j) const { return i * cols + j; }
+	pair<int, int> cell(int v) const { return make_pair(v / cols, v % cols); }
+	bool isOpen(int v) const { return isOpen(v / cols, v % cols); }
+
+	int neighbours(int v, int next[4]) const;
+	// Fill next with the open cells next to v, listed up, left, right,
+	// down like mapMazeToGraph's out edges, and return how many there are.
+
+private:
+	bool isOpen(int i, int j) const
+	{
+		return (bits[(size_t)i * rowWords + (j >> 6)] >> (j & 63)) & 1;
+	}
+
+	int rows, cols;
+	int rowWords;
+	const uint64_t *bits;   // the maze's bitmap, laid out as maze::bitmap() describes
+};
+
+gridView::gridView(const maze &m)
+	: rows(m.numRows()), cols(m.numCols()), rowWords(m.wordsPerRow()), bits(m.bitmap())
+{
+}
+
+int gridView::neighbours(int v, int next[4]) const
+{
+	int i = v / cols;
+	int j = v - i * cols;
+	// the word holding v and v's bit in it; left and right come from the
+	// same word unless v is at its end
+	const uint64_t *word = bits + (size_t)i * rowWords + (j >> 6);
+	int b = j & 63;
+	int count = 0;
+	if (i > 0 && ((word[-rowWords] >> b) & 1))
+		next[count++] = v - cols;
+	if (j > 0 && (((b > 0 ? word[0] >> (b - 1) : word[-1] >> 63)) & 1))
+		next[count++] = v - 1;
+	if (j < cols - 1 && (((b < 63 ? word[0] >> (b + 1) : word[1])) & 1))
+		next[count++] = v + 1;
+	if (i < rows - 1 && ((word[rowWords] >> b) & 1))
+		next[count++] = v + cols;
+	return count;
+}
+
+void checkGridEnds(const gridView &g, int s, int t)
+// Throw if s or t is not a cell of g.
+{
+	if (s < 0 || s >= g.numVertices() || t < 0 || t >= g.numVertices())
+		throw rangeError("Bad cell in grid search");
+}
+
+bool gridBFS(const gridView &g, int s, int t, searchContext &ctx)
+// find the fewest moves from cell s to cell t in g, leaving the weights
+// and preds of the explored region in ctx
+// returns true if t is accessible from s
+{
+	checkGridEnds(g, s, t);
+	ctx.reset(g.numVertices(), s);
+	if (!g.isOpen(s))
+		return false;
+
+	// cells are appended as they are reached and taken from the front
+	vector<int> fifo(1, s);
+	int next[4];
+	for (size_t head = 0; head < fifo.size(); head++)
+	{
+		int u = fifo[head];
+		ctx.settled[u] = true;
+		if (u == t)
+			return true;
+		int count = g.neighbours(u, next);
+		for (int k = 0; k < count; k++)
+		{
+			int v = next[k];
+			if (ctx.dist[v] == LargeValue)
+			{
+				ctx.dist[v] = ctx.dist[u] + 1;
+				ctx.pred[v] = u;
+				fifo.push_back(v);
+			}
+		}
+	}
+	return false;
+}
+
+bool gridDijkstra(const gridView &g, int s, int t, searchContext &ctx)
+// find lowest weight from cell s to cell t in g with dijkstra's, using a
+// bucket queue, leaving the weights and preds of the explored region in
+// ctx
+// returns true if t is accessible from s
+{
+	checkGridEnds(g, s, t);
+	ctx.reset(g.numVertices(), s);
+	if (!g.isOpen(s))
+		return false;
+
+	dialQueue<int> q(1);
+	q.minHeapInsert(s, 0);
+	int next[4];
+	while (!q.empty())
+	{
+		int u = q.extractMinHeapMinimum();
+		ctx.settled[u] = true;
+		if (u == t)
+			return true;
+		int count = g.neighbours(u, next);
+		for (int k = 0; k < count; k++)
+		{
+			int v = next[k];
+			if (ctx.dist[v] > ctx.dist[u] + 1)
+			{
+				bool reached = ctx.dist[v] != LargeValue;
+				ctx.dist[v] = ctx.dist[u] + 1;
+				ctx.pred[v] = u;
+				if (!reached)
+					q.minHeapInsert(v, ctx.dist[v]);
+				else if (!ctx.settled[v])
+					q.minHeapDecreaseKey(v, ctx.dist[v]);
+			}
+		}
+	}
+	return false;
+}
+
+bool gridAStar(const gridView &g, int s, int t, searchContext &ctx)
+// find lowest weight from cell s to cell t in g with A*, bounded by the
+// Manhattan distance to t and breaking ties toward t, leaving the weights
+// and preds of the explored region in ctx.  The bound is consistent on a
+// grid, so no cell is expanded twice
+// returns true if t is accessible from s
+{
+	checkGridEnds(g, s, t);
+	ctx.reset(g.numVertices(), s);
+	if (!g.isOpen(s))
+		return false;
+
+	int goalRow = g.cell(t).first;
+	int goalCol = g.cell(t).second;
+	auto bound = [&](int v)
+	{
+		return abs(g.cell(v).first - goalRow) + abs(g.cell(v).second - goalCol);
+	};
+
+	dHeap<long long, int, 4> q;
+	q.minHeapInsert(s, aStarKey(0, bound(s)));
+	int next[4];
+	while (!q.empty())
+	{
+		int u = q.extractMinHeapMinimum();
+		ctx.settled[u] = true;
+		if (u == t)
+			return true;
+		int count = g.neighbours(u, next);
+		for (int k = 0; k < count; k++)
+		{
+			int v = next[k];
+			int d = ctx.dist[u] + 1;
+			if (d >= ctx.dist[v] || ctx.settled[v])
+				continue;
+			bool reached = ctx.dist[v] != LargeValue;
+			ctx.dist[v] = d;
+			ctx.pred[v] = u;
+			if (reached)
+				q.minHeapDecreaseKey(v, aStarKey(d, bound(v)));
+			else
+				q.minHeapInsert(v, aStarKey(d, bound(v)));
+		}
+	}
+	return false;
+}
+
+#endif
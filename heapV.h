@@ -3,6 +3,11 @@
 // Implements min and max heaps and priority queue.
 //
 // This version is tailored to handle Boost graph objects.
+//
+// Items are vertex descriptors, which are used as indices into a position
+// map that records the slot each item occupies in the heap.  The map is kept
+// up to date on every move, so finding an item (and therefore decreasing
+// its key) does not require a scan of the heap.
 
 #ifndef Heap_h
 #define Heap_h
@@ -11,6 +16,7 @@
 //#define SmallValue -999999999
 
 #include "d_except.h"
+#include "solverStats.h"
 #include <vector>
 
 template <typename T, typename U>
@@ -18,8 +24,9 @@ class heapV
 {
 public:
 	heapV();
-	void initializeMaxHeap(vector<T> list2, U &g);
-	void initializeMinHeap(vector<T> list2, U &g);
+	~heapV() { StatBytes(heapBytes, bytes()); }
+	void initializeMaxHeap(const vector<T> &list2, U &g);
+	void initializeMinHeap(const vector<T> &list2, U &g);
 
 	void maxHeapify(int i, int heapSize, U &g);
 	void buildMaxHeap(int heapSize, U &g);
@@ -37,7 +44,9 @@ public:
 
 	T &getItem(int i) { return list[i]; }      // Return a reference to the ith item in the heap
 	int getIndex(T &key);
+	bool contains(T key);
 	int size() { return (int)list.size(); }
+	size_t bytes() const { return list.capacity() * sizeof(T) + position.capacity() * sizeof(int); }
 
 	T getMaxHeapMaximum();
 	T getMinHeapMinimum();
@@ -52,17 +61,60 @@ public:
 	void minHeapInsert(T key, U &g);
 
 private:
+	void minHeapSiftUp(int i, U &g);
+	void appendItems(const vector<T> &list2);
+	void setItem(int i, T key);
+	void swapItems(int i, int j);
+
 	vector<T> list;
+	vector<int> position;  // position[key] is the index of key in list, or -1
 };
 
 template <typename T, typename U>
 int heapV<T, U>::getIndex(T &key)
 // Return the index of the item key in the heap.  Assumes each item is unique.
 {
-	for (int i = 0; i < size(); i++)
-		if (getItem(i) == key)
-			return i;
-	throw rangeError("key not found in heap::getIndex");
+	StatCount(indexLookups);
+	if (!contains(key))
+		throw rangeError("key not found in heap::getIndex");
+	return position[key];
+}
+
+template <typename T, typename U>
+bool heapV<T, U>::contains(T key)
+// Return true if the item key is currently in the heap.
+{
+	return (size_t)key < position.size() && position[key] != -1;
+}
+
+template <typename T, typename U>
+void heapV<T, U>::setItem(int i, T key)
+// Store key in slot i and record its position.
+{
+	if ((size_t)key >= position.size())
+		position.resize(key + 1, -1);
+	list[i] = key;
+	position[key] = i;
+}
+
+template <typename T, typename U>
+void heapV<T, U>::appendItems(const vector<T> &list2)
+// Add the values in list2 after the items already held, as push_back did,
+// recording their positions.  The caller restores the heap property.
+{
+	int first = (int)list.size();
+	list.resize(first + list2.size());
+	for (int i = 0; i < (int)list2.size(); i++)
+		setItem(first + i, list2[i]);
+}
+
+template <typename T, typename U>
+void heapV<T, U>::swapItems(int i, int j)
+// Exchange the items in slots i and j, keeping the position map current.
+{
+	swap(list[i], list[j]);
+	position[list[i]] = i;
+	position[list[j]] = j;
 }
 
 template <typename T, typename U>
@@ -72,22 +124,18 @@ heapV<T, U>::heapV()
 }
 
 template <typename T, typename U>
-void heapV<T, U>::initializeMaxHeap(vector<T> list2, U &g)
-// Initialize a max heap from values in list2.
+void heapV<T, U>::initializeMaxHeap(const vector<T> &list2, U &g)
+// Add the values in list2 to the heap and make it a max heap.
 {
-	for (int i = 0; i < list2.size(); i++)
-		list.push_back(list2[i]);
-
+	appendItems(list2);
 	buildMaxHeap(size(), g);
 }
 
 template <typename T, typename U>
-void heapV<T, U>::initializeMinHeap(vector<T> list2, U &g)
-// Initialize a min heap from values in list2.
+void heapV<T, U>::initializeMinHeap(const vector<T> &list2, U &g)
+// Add the values in list2 to the heap and make it a min heap.
 {
-	for (int i = 0; i < list2.size(); i++)
-		list.push_back(list2[i]);
-
+	appendItems(list2);
 	buildMinHeap(size(), g);
 }
 
@@ -115,7 +163,7 @@ void heapV<T, U>::maxHeapify(int i, int heapSize, U &g)
 	// If the root isn't the largest, swap the root with the largest child and recurse.
 	if (largest != i)
 	{
-		swap(list[i], list[largest]);
+		swapItems(i, largest);
 		maxHeapify(largest, heapSize, g);
 	}
 }
@@ -144,7 +192,7 @@ void heapV<T, U>::minHeapify(int i, int heapSize, U &g)
 	if (smallest != i)
 	{
 		//cout << "Swapping " << list[i] << " and " << list[smallest] << endl;
-		swap(list[i], list[smallest]);
+		swapItems(i, smallest);
 		minHeapify(smallest, heapSize, g);
 	}
 }
@@ -189,11 +237,13 @@ template <typename T, typename U>
 T heapV<T, U>::extractMinHeapMinimum(U &g)
 // Return the smallest item in a min heap and remove it.
 {
+	StatCount(extractions);
 	if (size() < 1)
 		throw rangeError("heap too small in extractMinHeapMinimum");
 	T min = list[0];
-	list[0] = list[size() - 1];
+	swapItems(0, size() - 1);
 	//cout << "Swapping " << list[0] << " to the top" << endl;
+	position[min] = -1;
 	list.resize(size() - 1);
 	minHeapify(0, size(), g);
 	return min;
@@ -206,7 +256,8 @@ T heapV<T, U>::extractMaxHeapMaximum(U &g)
 	if (size() < 1)
 		throw rangeError("heap too small in extractMaxHeapMaximum");
 	T max = list[0];
-	list[0] = list[size() - 1];
+	swapItems(0, size() - 1);
+	position[max] = -1;
 	list.resize(size() - 1);
 	maxHeapify(0, size(), g);
 	return max;
@@ -219,7 +270,7 @@ void heapV<T, U>::maxHeapIncreaseKey(int i, U &g)
 {
 	while (i > 0 && g[list[parent(i)]].weight < g[list[i]].weight)
 	{
-		swap(list[i], list[parent(i)]);
+		swapItems(i, parent(i));
 		i = parent(i);
 	}
 }
@@ -228,12 +279,20 @@ template <typename T, typename U>
 void heapV<T, U>::minHeapDecreaseKey(int i, U &g)
 // Assumes the item at position i has had its value decreased.  Rebuilds the min-heap by performing
 // an insertion sort that finds the new item's correct location in the list.
+{
+	StatCount(decreaseKeys);
+	minHeapSiftUp(i, g);
+}
+
+template <typename T, typename U>
+void heapV<T, U>::minHeapSiftUp(int i, U &g)
+// Move the item at position i up until its parent's value is no larger.
 {
 	// cout << i << " " << list[i] << " " << list[parent(i)] << endl;
 
 	while (i > 0 && g[list[parent(i)]].weight > g[list[i]].weight)
 	{
-		swap(list[i], list[parent(i)]);
+		swapItems(i, parent(i));
 		i = parent(i);
 	}
 }
@@ -243,15 +302,18 @@ void heapV<T, U>::maxHeapInsert(T key, U &g)
 // Adds a new leaf then calls maxHeapIncreaseKey to move the key to the correct location.
 {
 	list.push_back(key);
-	maxHeapIncreaseKey(size() - 1);
+	setItem(size() - 1, key);
+	maxHeapIncreaseKey(size() - 1, g);
 }
 
 template <typename T, typename U>
 void heapV<T, U>::minHeapInsert(T key, U &g)
 // Adds a new leaf then calls minHeapDecreaseKey to move the key to the correct location.
 {
+	StatCount(inserts);
 	list.push_back(key);
-	minHeapDecreaseKey(size() - 1, g);
+	setItem(size() - 1, key);
+	minHeapSiftUp(size() - 1, g);
 }
 
 
@@ -270,7 +332,7 @@ void heapV<T, U>::heapsort(int heapSize, U &g)
 		// cout << "Position: " << i << endl;
 		// cout << "Swap" << endl;
 
-		swap(list[0], list[i]);
+		swapItems(0, i);
 		heapSize--;
 
 		// cout << "maxHeapify" << endl;
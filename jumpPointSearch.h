@@ -0,0 +1,170 @@
+// jumpPointSearch.h header file
+//
+// Implements Jump Point Search directly on the open cells of a maze, where
+// each move goes one cell up, down, left or right and costs 1.
+//
+// On a grid of uniform cost, most of the cells along a straight run need
+// not be expanded: the search only has to stop where the run ends at the
+// goal or where a side passage opens up that could not have been reached
+// as cheaply from the row or column behind.  So instead of expanding every
+// neighbour, the search jumps along each direction until it reaches such a
+// cell, a jump point, and only jump points enter the queue.  A vertical
+// jump also stops at any cell from which a horizontal jump finds a jump
+// point, so that turns off a vertical run are not missed.
+//
+// Jump points are taken in A* order, with the Manhattan distance to the
+// goal as the bound, which is consistent on the grid, so no jump point is
+// expanded twice.  The path between consecutive jump points is a straight
+// line, so the full path is filled back in cell by cell at the end and has
+// the same length a breadth-first search would find.
+
+#ifndef JumpPointSearch_h
+#define JumpPointSearch_h
+
+#include <algorithm>
+#include <stdlib.h>
+#include <vector>
+
+#include "d_except.h"
+#include "dHeap.h"
+#include "maze.h"
+#include "searchContext.h"
+#include "aStar.h"
+
+bool jumpPointSearch(maze &m, pair<int, int> start, pair<int, int> goal,
+	searchContext &ctx, vector<pair<int, int> > &path)
+// find a shortest path from cell start to cell goal in maze m, leaving the
+// cells in order in path.  ctx is indexed by i * numCols + j and holds the
+// weights and preds of the jump points reached; ctx.settled marks the jump
+// points expanded
+// returns true if goal is accessible from start
+{
+	int rows = m.numRows();
+	int cols = m.numCols();
+	int goalI = goal.first;
+	int goalJ = goal.second;
+	path.clear();
+
+	if (start.first < 0 || start.first >= rows || start.second < 0 || start.second >= cols ||
+		goalI < 0 || goalI >= rows || goalJ < 0 || goalJ >= cols)
+		throw rangeError("Bad cell in jumpPointSearch");
+
+	int s = start.first * cols + start.second;
+	int t = goalI * cols + goalJ;
+	ctx.reset(rows * cols, s);
+	if (!m.isLegal(start.first, start.second) || !m.isLegal(goalI, goalJ))
+		return false;
+
+	// true if (i, j) is in the maze and open
+	auto open = [&](int i, int j)
+	{
+		return i >= 0 && i < rows && j >= 0 && j < cols && m.isLegal(i, j);
+	};
+
+	// Jump from (i, j) along the row in direction dj, returning the cell
+	// index of the jump point reached or -1 if the run hits a wall first.
+	// A cell is a jump point if a passage opens above or below it that was
+	// closed on the cell behind it
+	auto jumpRow = [&](int i, int j, int dj)
+	{
+		while (true)
+		{
+			j += dj;
+			if (!open(i, j))
+				return -1;
+			if ((i == goalI && j == goalJ) ||
+				(open(i - 1, j) && !open(i - 1, j - dj)) ||
+				(open(i + 1, j) && !open(i + 1, j - dj)))
+				return i * cols + j;
+		}
+	};
+
+	// Jump from (i, j) along the column in direction di.  As well as the
+	// side passages, a cell is a jump point if a row jump from it finds one
+	auto jumpColumn = [&](int i, int j, int di)
+	{
+		while (true)
+		{
+			i += di;
+			if (!open(i, j))
+				return -1;
+			if ((i == goalI && j == goalJ) ||
+				(open(i, j - 1) && !open(i - di, j - 1)) ||
+				(open(i, j + 1) && !open(i - di, j + 1)) ||
+				jumpRow(i, j, -1) >= 0 || jumpRow(i, j, 1) >= 0)
+				return i * cols + j;
+		}
+	};
+
+	auto bound = [&](int v)
+	{
+		return abs(v / cols - goalI) + abs(v % cols - goalJ);
+	};
+
+	vector<int> &dist = ctx.dist;
+	dHeap<long long, int, 4> q;
+	q.minHeapInsert(s, aStarKey(0, bound(s)));
+
+	int next[4];
+	while (!q.empty())
+	{
+		int u = q.extractMinHeapMinimum();
+		ctx.settled[u] = true;
+		if (u == t)
+			break;
+
+		// Every direction but the one back the way the search came
+		int i = u / cols, j = u % cols;
+		int numNext = 0;
+		int p = ctx.pred[u];
+		if (p == LargeValue || p / cols == i)
+		{
+			int dj = p == LargeValue ? 0 : (j > p % cols ? 1 : -1);
+			if (dj >= 0) next[numNext++] = jumpRow(i, j, 1);
+			if (dj <= 0) next[numNext++] = jumpRow(i, j, -1);
+			next[numNext++] = jumpColumn(i, j, -1);
+			next[numNext++] = jumpColumn(i, j, 1);
+		}
+		else
+		{
+			int di = i > p / cols ? 1 : -1;
+			next[numNext++] = jumpColumn(i, j, di);
+			next[numNext++] = jumpRow(i, j, -1);
+			next[numNext++] = jumpRow(i, j, 1);
+		}
+
+		for (int k = 0; k < numNext; k++)
+		{
+			int v = next[k];
+			if (v < 0 || ctx.settled[v])
+				continue;
+			int d = dist[u] + abs(v / cols - i) + abs(v % cols - j);
+			if (d >= dist[v])
+				continue;
+			bool reached = dist[v] != LargeValue;
+			dist[v] = d;
+			ctx.pred[v] = u;
+			if (reached)
+				q.minHeapDecreaseKey(v, aStarKey(d, bound(v)));
+			else
+				q.minHeapInsert(v, aStarKey(d, bound(v)));
+		}
+	}
+	if (dist[t] == LargeValue)
+		return false;
+
+	// Fill in the straight runs between jump points, from the goal back
+	for (int v = t; v != s; v = ctx.pred[v])
+	{
+		int p = ctx.pred[v];
+		int di = (p / cols > v / cols) - (p / cols < v / cols);
+		int dj = (p % cols > v % cols) - (p % cols < v % cols);
+		for (int i = v / cols, j = v % cols; i * cols + j != p; i += di, j += dj)
+			path.push_back(make_pair(i, j));
+	}
+	path.push_back(start);
+	reverse(path.begin(), path.end());
+	return true;
+}
+
+#endif
@@ -3,52 +3,49 @@
 #include <vector>
 #include <list>
 #include <fstream>
+#include <sstream>
 #include <queue>
 #include <stack>
 
 #include "d_except.h"
 #include "heapV.h"
-
-#include <boost/graph/adjacency_list.hpp>
+#include "dHeap.h"
+#include "bucketQueue.h"
+#include "graph.h"
+#include "csrGraph.h"
+#include "graphLoader.h"
+#include "searchContext.h"
+#include "solverStats.h"
+#include "batchQuery.h"
+#include "parallelBellmanFord.h"
+#include "deltaStepping.h"
+#include "allPairs.h"
+#include "maze.h"
+#include "gridSearch.h"
+#include "jumpPointSearch.h"
+#include "bitmapBFS.h"
+#include "stopwatch.h"
+#include "sweepRecord.h"
 
 using namespace boost;
 using namespace std;
 
-#define LargeValue 99999999
-
-struct VertexProperties;
-struct EdgeProperties;
-
-typedef adjacency_list<vecS, vecS, bidirectionalS, VertexProperties, EdgeProperties> Graph;
-typedef Graph::vertex_descriptor Vertex;
-typedef pair<Graph::edge_descriptor, bool> Edge;
-
-struct VertexProperties
-{
-	Graph::vertex_descriptor pred; // predecessor node
-	int weight;
-	bool visited;
-	bool marked;
-};
+// dijkstra's uses a bucket queue when no edge weight exceeds this
+#define BucketQueueMaxWeight 255
 
-// Create a struct to hold properties for each edge
-struct EdgeProperties
+// priority queues that dijkstra can be run with
+enum queueType
 {
-	int weight;
-	bool visited;
-	bool marked;
+	binaryHeapQueue,   // heapV, keys are read from the graph
+	fourAryHeapQueue,  // dHeap with 4 children per node, keys stored inline
+	eightAryHeapQueue, // dHeap with 8 children per node, keys stored inline
+	dialBucketQueue,   // dialQueue, needs non-negative weights
+	radixHeapQueue,    // radixHeap, needs non-negative weights
+	deltaSteppingQueue, // deltaStepping's buckets on every core, CSR graphs only,
+	                   // needs non-negative weights
+	autoQueue          // chosen from the range of edge weights in the graph
 };
 
-// typedefs for graph elements
-typedef pair<Graph::vertex_iterator, Graph::vertex_iterator> NodeIteratorRange;
-typedef Graph::vertex_iterator NodeIterator;
-
-typedef pair<Graph::edge_iterator, Graph::edge_iterator> EdgeIteratorRange;
-typedef Graph::edge_iterator EdgeIterator;
-
-typedef pair<Graph::adjacency_iterator, Graph::adjacency_iterator> AdjIteratorRange;
-typedef Graph::adjacency_iterator AdjIterator;
-
 void clearVisited(Graph &g)
 // Mark all nodes in g as not visited.
 {
@@ -119,6 +116,9 @@ void initializeGraph(Graph &g,
 	fin >> n;
 	fin >> startId >> endId;
 	Graph::vertex_descriptor v;
+	GraphProperties &gp = g[graph_bundle];
+	gp.minEdgeWeight = INT_MAX;
+	gp.maxEdgeWeight = INT_MIN;
 
 	// Add nodes.
 	for (int i = 0; i < n; i++)
@@ -134,7 +134,10 @@ void initializeGraph(Graph &g,
 	{
 		fin >> i >> j >> e.weight;
 		add_edge(i, j, e, g);
+		gp.minEdgeWeight = min(gp.minEdgeWeight, e.weight);
+		gp.maxEdgeWeight = max(gp.maxEdgeWeight, e.weight);
 	}
+	StatBytes(boostGraphBytes, graphBytes(g));
 }
 
 // function that adjusts the estimate of the weight of node v using the edge between u and v
@@ -142,11 +145,13 @@ void relax(Graph &g, Vertex u, Vertex v)
 {
 	// get edge check if it exists
 	Edge e = edge(u, v, g);
+	StatCount(relaxCalls);
 	if (e.second)
 	{
 		// if the current weight is higher than weight of u + weight of edge
 		if (g[v].weight > g[u].weight + g[e.first].weight)
 		{
+			StatCount(relaxations);
 			// adjust current weight to new value
 			g[v].weight = g[u].weight + g[e.first].weight;
 			// change predecessor
@@ -157,20 +162,25 @@ void relax(Graph &g, Vertex u, Vertex v)
 
 // function which uses an edge e to perform the relax
 // this function was added to handle multiple out_edges coming from one node
-void relax_edge(Graph &g, Graph::edge_descriptor e)
+// returns true if the weight of the target changed
+bool relax_edge(Graph &g, Graph::edge_descriptor e)
 {
 	// from edge, get u and v
 	Vertex u = source(e, g);
 	Vertex v = target(e, g);
 	// get edge weight
 	int w = g[e].weight;
+	StatCount(relaxCalls);
 	// if current weight is more than u + w
 	if (g[v].weight > g[u].weight + w)
 	{
+		StatCount(relaxations);
 		// adjust current value and change predecessor
 		g[v].weight = g[u].weight + w;
 		g[v].pred = u;
+		return true;
 	}
+	return false;
 }
 
 // setup the graph for operation by algorithms
@@ -189,10 +199,19 @@ void initializeSingleSource(Graph &g, Vertex s)
 	g[s].weight = 0;
 }
 
-// find lowest weight to each node in graph g starting from vertex s
-// all nums must be positive
-// returns true if all nodes are accessible from node s
-bool dijkstra(Graph &g, Vertex s)
+// returns true if every node in g has been reached by a search
+bool allReached(Graph &g)
+{
+	NodeIteratorRange vitR = vertices(g);
+	for (NodeIterator it = vitR.first; it != vitR.second; it++)
+	{
+		if (g[*it].weight == LargeValue) return false;
+	}
+	return true;
+}
+
+// dijkstra's using heapV, which orders vertices by their weight in g
+bool dijkstraBinaryHeap(Graph &g, Vertex s)
 {
 	// init the graph
 	initializeSingleSource(g, s);
@@ -218,32 +237,115 @@ bool dijkstra(Graph &g, Vertex s)
 		// make sure it isn't negative
 		if (g[u].weight < 0)
 			throw rangeError("negative edge found");
-		// loop over the adjacents
-		AdjIteratorRange aitR = adjacent_vertices(u, g);
-		for (AdjIterator v = aitR.first; v != aitR.second; ++v)
+		// loop over the out edges, so parallel edges are each considered
+		OutEdgeIteratorRange eitR = out_edges(u, g);
+		for (OutEdgeIterator it = eitR.first; it != eitR.second; ++it)
 		{
 			// relax the adjacents
-			Vertex ver = *v;
-			relax(g, u, *v);
+			Vertex ver = target(*it, g);
+			relax_edge(g, *it);
 			// adjust the min queue as necessary
-			try
-			{
+			if (q.contains(ver))
 				q.minHeapDecreaseKey(q.getIndex(ver), g);
-			}
-			catch (rangeError e)
-			{
-				// noop
-			}
 		}
 	}
 
 	// loop through to see if any node has not been reached by the algorithm
-	vitR = vertices(g);
+	return allReached(g);
+}
+
+// dijkstra's using a queue Q that keeps a copy of each vertex's weight next
+// to the vertex, so the queue never has to look into g
+template <typename Q>
+bool dijkstraInlineKeys(Graph &g, Vertex s, Q &q)
+{
+	// init the graph
+	initializeSingleSource(g, s);
+
+	// add the vertices and their current weights to a list
+	vector<typename Q::entry> list2;
+	list2.reserve(num_vertices(g));
+	NodeIteratorRange vitR = vertices(g);
 	for (NodeIterator it = vitR.first; it != vitR.second; it++)
 	{
-		if (g[*it].weight == LargeValue) return false;
+		list2.push_back({ g[*it].weight, *it });
+	}
+	// hand the list over to create a min priority queue
+	q.initializeMinHeap(std::move(list2));
+
+	// while the queue is not empty
+	while (!q.empty())
+	{
+		// take the lowest weight vertex
+		Vertex u = q.extractMinHeapMinimum();
+		// make sure it isn't negative
+		if (g[u].weight < 0)
+			throw rangeError("negative edge found");
+		// relax each out edge, and copy any improvement into the queue
+		OutEdgeIteratorRange eitR = out_edges(u, g);
+		for (OutEdgeIterator it = eitR.first; it != eitR.second; ++it)
+		{
+			Vertex v = target(*it, g);
+			int old = g[v].weight;
+			relax_edge(g, *it);
+			if (g[v].weight < old && q.contains(v))
+				q.minHeapDecreaseKey(v, g[v].weight);
+		}
+	}
+
+	return allReached(g);
+}
+
+// resolve autoQueue to a queue suited to edge weights in [minWeight, maxWeight]
+queueType chooseQueue(queueType qt, int minWeight, int maxWeight)
+{
+	if (qt != autoQueue)
+		return qt;
+	// bucket queues can't hold keys below the last one extracted, so a
+	// graph that might have negative weights gets a heap
+	if (minWeight < 0)
+		return binaryHeapQueue;
+	if (maxWeight <= BucketQueueMaxWeight)
+		return dialBucketQueue;
+	return radixHeapQueue;
+}
+
+// find lowest weight to each node in graph g starting from vertex s
+// all nums must be positive
+// returns true if all nodes are accessible from node s
+bool dijkstra(Graph &g, Vertex s, queueType qt = autoQueue)
+{
+	const GraphProperties &gp = g[graph_bundle];
+	// if there are no edges, any queue will do
+	int maxWeight = max(gp.maxEdgeWeight, 0);
+	qt = chooseQueue(qt, gp.minEdgeWeight, maxWeight);
+
+	switch (qt)
+	{
+	case fourAryHeapQueue:
+	{
+		dHeap<int, Vertex, 4> q;
+		return dijkstraInlineKeys(g, s, q);
+	}
+	case eightAryHeapQueue:
+	{
+		dHeap<int, Vertex, 8> q;
+		return dijkstraInlineKeys(g, s, q);
+	}
+	case dialBucketQueue:
+	{
+		dialQueue<Vertex> q(maxWeight);
+		return dijkstraInlineKeys(g, s, q);
+	}
+	case radixHeapQueue:
+	{
+		radixHeap<Vertex> q;
+		return dijkstraInlineKeys(g, s, q);
+	}
+	// deltaStepping only runs over a CSR graph, so it gets heapV here too
+	default:
+		return dijkstraBinaryHeap(g, s);
 	}
-	return true;
 }
 
 // find lowest weight to each node in graph g starting from vertex s
@@ -255,15 +357,20 @@ bool bellmanFord(Graph &g, Vertex s)
 	initializeSingleSource(g, s);
 	// loop from 1 to numVertices - 1
 	int numVertices = num_vertices(g);
-	for (int i = 1; i < numVertices; i++)
+	bool changed = true;
+	for (int i = 1; i < numVertices && changed; i++)
 	{
 		// loop over all edges
+		// if a whole pass changes nothing, no later pass can either
+		changed = false;
+		StatCount(bellmanFordPasses);
 		EdgeIteratorRange eitR = edges(g);
 		for (EdgeIterator it = eitR.first; it != eitR.second; it++)
 		{
 			// relax the node v given by edge e(u,v)
 			Graph::edge_descriptor e = *it;
-			relax_edge(g, e);
+			if (relax_edge(g, e))
+				changed = true;
 		}
 	}
 	// check each edge to ensure there are no cycles
@@ -279,6 +386,423 @@ bool bellmanFord(Graph &g, Vertex s)
 	return true;
 }
 
+// dijkstra's over a CSR graph using a queue Q that keeps a copy of each
+// vertex's weight next to the vertex
+template <typename Q>
+bool dijkstraInlineKeys(const csrGraph &g, int s, searchContext &ctx, Q &q)
+{
+	int n = g.numVertices();
+	vector<int> &dist = ctx.dist;
+	ctx.reset(n, s);
+
+	// add the vertices and their current weights to a list
+	vector<typename Q::entry> list2;
+	list2.reserve(n);
+	for (int v = 0; v < n; v++)
+		list2.push_back({ dist[v], v });
+	// hand the list over to create a min priority queue
+	q.initializeMinHeap(std::move(list2));
+
+	// while the queue is not empty
+	while (!q.empty())
+	{
+		// take the lowest weight vertex
+		int u = q.extractMinHeapMinimum();
+		ctx.settled[u] = true;
+		// make sure it isn't negative
+		if (dist[u] < 0)
+			throw rangeError("negative edge found");
+		// relax each out edge, and copy any improvement into the queue
+		for (int e = g.beginEdge(u); e < g.endEdge(u); e++)
+		{
+			int v = g.target(e);
+			StatCount(relaxCalls);
+			if (dist[v] > dist[u] + g.weight(e))
+			{
+				StatCount(relaxations);
+				dist[v] = dist[u] + g.weight(e);
+				ctx.pred[v] = u;
+				if (!ctx.settled[v])
+					q.minHeapDecreaseKey(v, dist[v]);
+			}
+		}
+	}
+
+	// see if any node has not been reached by the algorithm
+	for (int v = 0; v < n; v++)
+		if (dist[v] == LargeValue)
+			return false;
+	return true;
+}
+
+// find lowest weight to each node in CSR graph g starting from vertex s,
+// leaving the weights and preds in ctx
+// all nums must be positive
+// returns true if all nodes are accessible from node s
+bool dijkstra(const csrGraph &g, int s, searchContext &ctx, queueType qt = autoQueue)
+{
+	// if there are no edges, any queue will do
+	int maxWeight = max(g.maxEdgeWeight(), 0);
+	qt = chooseQueue(qt, g.minEdgeWeight(), maxWeight);
+
+	switch (qt)
+	{
+	case fourAryHeapQueue:
+	{
+		dHeap<int, int, 4> q;
+		return dijkstraInlineKeys(g, s, ctx, q);
+	}
+	case eightAryHeapQueue:
+	{
+		dHeap<int, int, 8> q;
+		return dijkstraInlineKeys(g, s, ctx, q);
+	}
+	case dialBucketQueue:
+	{
+		dialQueue<int> q(maxWeight);
+		return dijkstraInlineKeys(g, s, ctx, q);
+	}
+	case radixHeapQueue:
+	{
+		radixHeap<int> q;
+		return dijkstraInlineKeys(g, s, ctx, q);
+	}
+	case deltaSteppingQueue:
+		return deltaStepping(g, s, ctx);
+	default:
+	{
+		// heapV reads its keys from a Boost graph, so a CSR graph uses
+		// the inline-key heap with two children per node instead
+		dHeap<int, int, 2> q;
+		return dijkstraInlineKeys(g, s, ctx, q);
+	}
+	}
+}
+
+// dijkstra's over a CSR graph from s that stops as soon as t is settled
+// vertices go into the queue Q when they are first reached instead of all
+// up front, so the queue only ever holds the frontier, and a search for an
+// unreachable t ends when the frontier runs out rather than draining
+// every unreached vertex
+template <typename Q>
+bool dijkstraToTarget(const csrGraph &g, int s, int t, searchContext &ctx, Q &q)
+{
+	vector<int> &dist = ctx.dist;
+	ctx.reset(g.numVertices(), s);
+	q.minHeapInsert(s, 0);
+
+	// while there is a frontier
+	while (!q.empty())
+	{
+		// take the lowest weight vertex
+		int u = q.extractMinHeapMinimum();
+		ctx.settled[u] = true;
+		// make sure it isn't negative
+		if (dist[u] < 0)
+			throw rangeError("negative edge found");
+		if (u == t)
+			return true;
+		// relax each out edge, queueing newly reached vertices
+		for (int e = g.beginEdge(u); e < g.endEdge(u); e++)
+		{
+			int v = g.target(e);
+			StatCount(relaxCalls);
+			if (dist[v] > dist[u] + g.weight(e))
+			{
+				StatCount(relaxations);
+				bool reached = dist[v] != LargeValue;
+				dist[v] = dist[u] + g.weight(e);
+				ctx.pred[v] = u;
+				if (!reached)
+					q.minHeapInsert(v, dist[v]);
+				else if (!ctx.settled[v])
+					q.minHeapDecreaseKey(v, dist[v]);
+			}
+		}
+	}
+	return false;
+}
+
+// find lowest weight from vertex s to vertex t in CSR graph g, leaving the
+// weights and preds of the explored region in ctx
+// all nums must be positive
+// returns true if t is accessible from node s
+bool dijkstra(const csrGraph &g, int s, int t, searchContext &ctx, queueType qt = autoQueue)
+{
+	// if there are no edges, any queue will do
+	int maxWeight = max(g.maxEdgeWeight(), 0);
+	qt = chooseQueue(qt, g.minEdgeWeight(), maxWeight);
+
+	switch (qt)
+	{
+	case fourAryHeapQueue:
+	{
+		dHeap<int, int, 4> q;
+		return dijkstraToTarget(g, s, t, ctx, q);
+	}
+	case eightAryHeapQueue:
+	{
+		dHeap<int, int, 8> q;
+		return dijkstraToTarget(g, s, t, ctx, q);
+	}
+	case dialBucketQueue:
+	{
+		dialQueue<int> q(maxWeight);
+		return dijkstraToTarget(g, s, t, ctx, q);
+	}
+	case radixHeapQueue:
+	{
+		radixHeap<int> q;
+		return dijkstraToTarget(g, s, t, ctx, q);
+	}
+	// deltaStepping can't stop early at t, so it settles every vertex
+	case deltaSteppingQueue:
+		deltaStepping(g, s, ctx);
+		return ctx.dist[t] != LargeValue;
+	default:
+	{
+		dHeap<int, int, 2> q;
+		return dijkstraToTarget(g, s, t, ctx, q);
+	}
+	}
+}
+
+// point-to-point dijkstra's from s to t over CSR graph g, where rev is
+// g.reversed()
+// a forward search from s over g and a backward search from t over the in
+// edges in rev take turns, each settling the vertex nearest its own end.
+// whenever an edge links the two searches, the s-t path through it is a
+// candidate.  once the two nearest unsettled weights add up to at least
+// the best candidate, no shorter path can remain, so the search stops
+// without settling the rest of the graph
+// the path is left in fwd as if a forward search had reached t, so
+// fwd.pred leads back from t to s.  bwd holds the backward search
+// all nums must be positive
+// returns true if t is reachable from s
+bool bidirectionalDijkstra(const csrGraph &g, const csrGraph &rev, int s, int t,
+	searchContext &fwd, searchContext &bwd)
+{
+	int n = g.numVertices();
+	if (g.numEdges() > 0 && g.minEdgeWeight() < 0)
+		throw rangeError("negative edge found");
+	fwd.reset(n, s);
+	bwd.reset(n, t);
+
+	// vertices are queued when first reached rather than all up front
+	dHeap<int, int, 4> qf, qb;
+	qf.minHeapInsert(s, 0);
+	qb.minHeapInsert(t, 0);
+
+	// weight of the best s-t path seen, and a vertex on it
+	int best = s == t ? 0 : LargeValue;
+	int meet = s == t ? s : -1;
+
+	while (!qf.empty() && !qb.empty() &&
+		qf.getMinHeapMinimumKey() + qb.getMinHeapMinimumKey() < best)
+	{
+		// advance the side whose nearest vertex is closer
+		bool forward = qf.getMinHeapMinimumKey() <= qb.getMinHeapMinimumKey();
+		const csrGraph &h = forward ? g : rev;
+		searchContext &mine = forward ? fwd : bwd;
+		searchContext &other = forward ? bwd : fwd;
+		dHeap<int, int, 4> &q = forward ? qf : qb;
+
+		int u = q.extractMinHeapMinimum();
+		mine.settled[u] = true;
+		for (int e = h.beginEdge(u); e < h.endEdge(u); e++)
+		{
+			int v = h.target(e);
+			int d = mine.dist[u] + h.weight(e);
+			StatCount(relaxCalls);
+			if (d < mine.dist[v])
+			{
+				StatCount(relaxations);
+				// a vertex already reached is still queued, since with no
+				// negative weights a settled vertex can't improve
+				if (mine.dist[v] == LargeValue)
+					q.minHeapInsert(v, d);
+				else
+					q.minHeapDecreaseKey(v, d);
+				mine.dist[v] = d;
+				mine.pred[v] = u;
+			}
+			if (other.dist[v] != LargeValue && mine.dist[v] + other.dist[v] < best)
+			{
+				best = mine.dist[v] + other.dist[v];
+				meet = v;
+			}
+		}
+	}
+	if (meet < 0)
+		return false;
+
+	// the path runs from s to meet by fwd.pred, then on to t by bwd.pred.
+	// with zero weight edges the two halves can share a vertex, and joining
+	// them there would leave a loop in fwd.pred, so meet instead at the
+	// shared vertex nearest t; what is cut out is a cycle of weight 0
+	vector<char> onPath(n, false);
+	for (int v = meet; v != LargeValue; v = fwd.pred[v])
+		onPath[v] = true;
+	for (int v = meet; ; v = bwd.pred[v])
+	{
+		if (onPath[v])
+			meet = v;
+		if (v == t)
+			break;
+	}
+
+	// extend the forward preds along the backward search's path to t.  no
+	// vertex after meet is on the forward path, so the preds overwritten
+	// there are off it, and a vertex the forward search already settled
+	// keeps its weight, since a shorter one would give a shorter s-t path
+	for (int v = meet; v != t; v = bwd.pred[v])
+	{
+		int next = bwd.pred[v];
+		fwd.pred[next] = v;
+		fwd.dist[next] = fwd.dist[v] + bwd.dist[v] - bwd.dist[next];
+	}
+	return true;
+}
+
+// find lowest weight to each node in CSR graph g starting from vertex s,
+// leaving the weights and preds in ctx
+// can operate on negatives
+// will return false if it detects a negative cycle
+bool bellmanFord(const csrGraph &g, int s, searchContext &ctx)
+{
+	int n = g.numVertices();
+	vector<int> &dist = ctx.dist;
+	ctx.reset(n, s);
+	// loop from 1 to numVertices - 1
+	bool changed = true;
+	for (int i = 1; i < n && changed; i++)
+	{
+		// loop over all edges, grouped by source
+		// if a whole pass changes nothing, no later pass can either
+		changed = false;
+		StatCount(bellmanFordPasses);
+		for (int u = 0; u < n; u++)
+			for (int e = g.beginEdge(u); e < g.endEdge(u); e++)
+			{
+				// relax the node v given by edge e(u,v)
+				int v = g.target(e);
+				StatCount(relaxCalls);
+				if (dist[v] > dist[u] + g.weight(e))
+				{
+					StatCount(relaxations);
+					dist[v] = dist[u] + g.weight(e);
+					ctx.pred[v] = u;
+					changed = true;
+				}
+			}
+	}
+	// check each edge to ensure there are no cycles
+	for (int u = 0; u < n; u++)
+		for (int e = g.beginEdge(u); e < g.endEdge(u); e++)
+			if (dist[g.target(e)] > dist[u] + g.weight(e))
+				return false;
+	return true;
+}
+
+// find lowest weight to each node in CSR graph g starting from vertex s,
+// leaving the weights and preds in ctx
+// queue based bellman-ford: only the out edges of vertices whose weight
+// changed are relaxed, taking the vertices in FIFO order
+// the preds form a tree rooted at s, kept as a list of its vertices in
+// preorder with their depths.  when a vertex v improves, its subtree is
+// cut out of the tree, since every weight in it is now out of date.  if the
+// vertex u that improved v is in that subtree, the improvement went around
+// a cycle of negative total weight, so a cycle is reported as soon as it is
+// closed rather than after numVertices - 1 passes
+// will return false if it detects a negative cycle reachable from s
+bool bellmanFordQueue(const csrGraph &g, int s, searchContext &ctx)
+{
+	int n = g.numVertices();
+	vector<int> &dist = ctx.dist;
+	vector<int> &pred = ctx.pred;
+	ctx.reset(n, s);
+
+	// preorder thread through the tree, and the depth of each tree vertex
+	// depth is -1 for a vertex that is not in the tree
+	vector<int> next(n), prev(n), depth(n, -1);
+	next[s] = prev[s] = s;
+	depth[s] = 0;
+
+	// vertices waiting to have their out edges relaxed
+	queue<int> q;
+	vector<char> queued(n, false);
+	q.push(s);
+	queued[s] = true;
+#ifdef LicStats
+	// vertices left to take in the current FIFO round, the counterpart of
+	// a pass; the ones queued meanwhile make up the next round
+	size_t roundLeft = 0;
+#endif
+
+	while (!q.empty())
+	{
+#ifdef LicStats
+		if (roundLeft == 0)
+		{
+			StatCount(bellmanFordPasses);
+			roundLeft = q.size();
+		}
+		roundLeft--;
+#endif
+		int u = q.front();
+		q.pop();
+		queued[u] = false;
+		// skip a vertex that was cut out of the tree after it was queued;
+		// it will be queued again when its weight improves
+		if (depth[u] < 0)
+			continue;
+
+		for (int e = g.beginEdge(u); e < g.endEdge(u); e++)
+		{
+			int v = g.target(e);
+			StatCount(relaxCalls);
+			if (dist[v] <= dist[u] + g.weight(e))
+				continue;
+			StatCount(relaxations);
+			dist[v] = dist[u] + g.weight(e);
+
+			if (v == u)
+				return false;
+			if (depth[v] >= 0)
+			{
+				// cut v and its subtree out of the thread
+				int x = next[v];
+				while (x != s && depth[x] > depth[v])
+				{
+					if (x == u)
+						return false;
+					depth[x] = -1;
+					x = next[x];
+				}
+				if (v == s)
+					return false;
+				next[prev[v]] = x;
+				prev[x] = prev[v];
+			}
+
+			// hang v under u, straight after u in preorder
+			pred[v] = u;
+			depth[v] = depth[u] + 1;
+			prev[v] = u;
+			next[v] = next[u];
+			prev[next[u]] = v;
+			next[u] = v;
+
+			if (!queued[v])
+			{
+				q.push(v);
+				queued[v] = true;
+			}
+		}
+	}
+	return true;
+}
+
 // print path held in a stack
 void printPath(stack<Vertex> &s)
 {
@@ -298,43 +822,528 @@ void printPath(stack<Vertex> &s)
 	cout << endl;
 }
 
-int main()
+// answer every query in queryFile against the graph in graphFile using
+// numThreads threads (0 for one per core), and print one line per query
+// in the order the queries appear.  queryFile holds whitespace separated
+// source and target pairs.
+void runBatch(const string &graphFile, const string &queryFile, int numThreads)
 {
+	csrGraph g;
+	int start, end;
+	loadGraph(graphFile, g, start, end, numThreads);
+
+	ifstream qin(queryFile.c_str());
+	if (!qin)
+		throw fileOpenError(queryFile);
+	vector<query> queries;
+	query q;
+	while (qin >> q.source >> q.target)
+		queries.push_back(q);
+	qin.close();
+
+	vector<queryResult> results = runQueries(g, queries,
+		[](const csrGraph &g, int s, int t, searchContext &ctx) { dijkstra(g, s, t, ctx); },
+		numThreads);
+
+	// collect the output and write it once
+	ostringstream out;
+	for (int i = 0; i < (int)results.size(); i++)
+	{
+		out << queries[i].source << " " << queries[i].target << ": ";
+		if (!results[i].ok)
+			out << "search failed\n";
+		else if (results[i].path.empty())
+			out << "no shortest path exists\n";
+		else
+		{
+			out << results[i].dist << " Shortest path:";
+			for (int j = 0; j < (int)results[i].path.size(); j++)
+				out << " " << results[i].path[j];
+			out << "\n";
+		}
+	}
+	cout << out.str();
+}
+
+// engines the sweep driver can run.  the graph engines search graph files
+// and the graph mapMazeToGraph builds from a maze.  the maze engines only
+// search mazes, from the top left cell to the bottom right one
+const char *graphEngines[] = { "bellmanford", "bellmanfordparallel", "dijkstra", "deltastepping" };
+const char *mazeEngines[] = { "astar", "bfs", "griddijkstra", "gridastar", "jps", "bitmapbfs" };
+const int numGraphEngines = sizeof(graphEngines) / sizeof(graphEngines[0]);
+const int numMazeEngines = sizeof(mazeEngines) / sizeof(mazeEngines[0]);
+
+bool isEngine(const string &name, const char *const *engines, int count)
+{
+	return find(engines, engines + count, name) != engines + count;
+}
+
+// fill in r's status, path length and path cost from a search of g from s
+// to t that left its preds in ctx
+void recordPath(const csrGraph *g, const searchContext &ctx, int s, int t, sweepRecord &r)
+{
+	vector<int> path;
+	tracePath(ctx, s, t, path);
+	if (path.empty())
+	{
+		r.status = "no path";
+		return;
+	}
+	r.pathLength = (long long)path.size() - 1;
+	r.pathCost = r.pathLength;
+	// on a graph, add up the cheapest edge between each pair on the path
+	if (g != NULL)
+	{
+		r.pathCost = 0;
+		for (size_t k = 0; k + 1 < path.size(); k++)
+		{
+			int best = INT_MAX;
+			for (int e = g->beginEdge(path[k]); e < g->endEdge(path[k]); e++)
+				if (g->target(e) == path[k + 1])
+					best = min(best, g->weight(e));
+			r.pathCost += best;
+		}
+	}
+}
+
+// run graph engine r.engine on g from start to end, timing the build of
+// anything it needs besides g and the search itself.  rev is g.reversed()
+// if the caller already has it, or NULL to build it here when needed.  the
+// parallel engines use numThreads threads
+void sweepGraph(const csrGraph &g, const csrGraph *rev, int start, int end, int numThreads,
+	sweepRecord &r)
+{
+	searchContext ctx;
+	stopwatch clock;
 	try
 	{
-		ifstream fin;
+		if (r.engine == "bellmanford")
+		{
+			r.buildMs = 0;
+			bool ok = bellmanFordQueue(g, start, ctx);
+			r.solveMs = clock.ms();
+			if (!ok)
+			{
+				r.status = "negative cycle";
+				return;
+			}
+		}
+		else if (r.engine == "deltastepping")
+		{
+			r.buildMs = 0;
+			deltaStepping(g, start, ctx, 0, numThreads);
+			r.solveMs = clock.ms();
+		}
+		else if (r.engine == "bellmanfordparallel")
+		{
+			inEdgeList in(g);
+			r.buildMs = clock.lap();
+			bool ok = bellmanFordParallel(in, start, ctx, numThreads);
+			r.solveMs = clock.ms();
+			if (!ok)
+			{
+				r.status = "negative cycle";
+				return;
+			}
+		}
+		else
+		{
+			// as the interactive mode does, search from both ends unless
+			// there are negative weights
+			if (g.minEdgeWeight() >= 0)
+			{
+				csrGraph built;
+				if (rev == NULL)
+				{
+					built = g.reversed();
+					rev = &built;
+				}
+				r.buildMs = clock.lap();
+				searchContext bwd;
+				bidirectionalDijkstra(g, *rev, start, end, ctx, bwd);
+			}
+			else
+			{
+				r.buildMs = clock.lap();
+				dijkstra(g, start, end, ctx);
+			}
+			r.solveMs = clock.ms();
+		}
+	}
+	catch (rangeError e)
+	{
+		r.solveMs = clock.ms();
+		r.status = "failed";
+		r.message = e.what();
+		return;
+	}
+	recordPath(&g, ctx, start, end, r);
+}
+
+// run maze engine r.engine on m from the top left cell to the bottom right
+// one.  g is mapMazeToGraph's graph of m, built on first use, and
+// graphBuildMs the time that took.  the parallel engines use numThreads
+// threads
+void sweepMaze(maze &m, csrGraph &g, double &graphBuildMs, int numThreads, sweepRecord &r)
+{
+	pair<int, int> start(0, 0), goal(m.numRows() - 1, m.numCols() - 1);
+	searchContext ctx;
+	stopwatch clock;
+	bool ends = m.isLegal(start.first, start.second) && m.isLegal(goal.first, goal.second);
+
+	// the graph engines and A* search the maze's graph
+	if (isEngine(r.engine, graphEngines, numGraphEngines) || r.engine == "astar")
+	{
+		if (graphBuildMs < 0)
+		{
+			m.mapMazeToGraph(g);
+			graphBuildMs = clock.ms();
+		}
+		if (!ends)
+		{
+			r.buildMs = graphBuildMs;
+			r.status = "no path";
+			return;
+		}
+		int s = (int)m.getNode(start.first, start.second);
+		int t = (int)m.getNode(goal.first, goal.second);
+		if (r.engine != "astar")
+		{
+			// every passage of a maze's graph goes both ways with the same
+			// weight, so the graph is its own reverse
+			sweepGraph(g, &g, s, t, numThreads, r);
+			r.buildMs += graphBuildMs;
+			return;
+		}
+		r.buildMs = graphBuildMs;
+		clock.restart();
+		aStar(g, s, t, ctx, true);
+		r.solveMs = clock.ms();
+		recordPath(&g, ctx, s, t, r);
+		return;
+	}
+
+	if (r.engine == "jps" || r.engine == "bitmapbfs")
+	{
+		long long d = LargeValue;
+		if (r.engine == "jps")
+		{
+			vector<pair<int, int> > path;
+			if (jumpPointSearch(m, start, goal, ctx, path))
+				d = (long long)path.size() - 1;
+		}
+		else
+			d = bitmapBFS(m, start, goal);
+		r.solveMs = clock.ms();
+		if (d == LargeValue)
+			r.status = "no path";
+		else
+			r.pathLength = r.pathCost = d;
+		return;
+	}
+
+	gridView gv(m);
+	r.buildMs = clock.lap();
+	int s = gv.index(start.first, start.second);
+	int t = gv.index(goal.first, goal.second);
+	if (r.engine == "bfs")
+		gridBFS(gv, s, t, ctx);
+	else if (r.engine == "griddijkstra")
+		gridDijkstra(gv, s, t, ctx);
+	else
+		gridAStar(gv, s, t, ctx);
+	r.solveMs = clock.ms();
+	recordPath(NULL, ctx, s, t, r);
+}
+
+// run each engine in engines that applies to fileName and write one record
+// per engine to out, all at once.  a file that can't be read gets a single
+// record saying why
+void sweepFile(const string &fileName, const vector<string> &engines, int numThreads,
+	sweepFormat format, ostream &out)
+{
+	ostringstream records;
+	sweepRecord base(fileName);
+
+#ifdef LicStats
+	// every engine's figures start from those of loading the file
+	currentStats().reset();
+	solverStats loaded;
+	auto startStats = [&]() { currentStats() = loaded; };
+	auto endStats = [&](sweepRecord &r)
+	{
+		currentStats().loadMs = r.loadMs;
+		currentStats().buildMs = r.buildMs;
+		currentStats().solveMs = r.solveMs;
+		ostringstream stats;
+		currentStats().writeJson(stats);
+		r.stats = stats.str();
+	};
+#else
+	auto startStats = [&]() {};
+	auto endStats = [&](sweepRecord &) {};
+#endif
+
+	try
+	{
+		stopwatch clock;
+		if (isMazeFile(fileName))
+		{
+			maze m(fileName);
+			base.loadMs = clock.ms();
+#ifdef LicStats
+			loaded = currentStats();
+#endif
+			base.kind = "maze";
+			countMoves(m, base.vertices, base.edges);
+
+			csrGraph g;
+			double graphBuildMs = -1;
+			for (size_t k = 0; k < engines.size(); k++)
+			{
+				sweepRecord r = base;
+				r.engine = engines[k];
+				startStats();
+				sweepMaze(m, g, graphBuildMs, numThreads, r);
+				endStats(r);
+				writeSweepRecord(records, r, format);
+			}
+		}
+		else
+		{
+			csrGraph g;
+			int start, end;
+			loadGraph(fileName, g, start, end, numThreads);
+			base.loadMs = clock.ms();
+#ifdef LicStats
+			loaded = currentStats();
+#endif
+			base.kind = "graph";
+			base.vertices = g.numVertices();
+			base.edges = g.numEdges();
+
+			for (size_t k = 0; k < engines.size(); k++)
+				if (isEngine(engines[k], graphEngines, numGraphEngines))
+				{
+					sweepRecord r = base;
+					r.engine = engines[k];
+					startStats();
+					sweepGraph(g, NULL, start, end, numThreads, r);
+					endStats(r);
+					writeSweepRecord(records, r, format);
+				}
+		}
+	}
+	catch (baseException e)
+	{
+		// drop any records already made, so the file has just this one
+		records.str("");
+		base.status = "error";
+		base.message = e.what();
+		writeSweepRecord(records, base, format);
+	}
+	string text = records.str();
+	out.write(text.data(), text.size());
+}
+
+// sweep mode: lic-5 -sweep [-format json|csv] [-engines name,...] [-threads n] file...
+// engines defaults to all of them but bellmanfordparallel; the ones that don't apply to a file
+// are skipped for it.  threads is used for loading graph files and by the
+// parallel engines, and defaults to 1.  returns main's exit status
+int runSweep(int argc, char *argv[])
+{
+	sweepFormat format = jsonFormat;
+	vector<string> engines(graphEngines, graphEngines + numGraphEngines);
+	engines.insert(engines.end(), mazeEngines, mazeEngines + numMazeEngines);
+	// the parallel Bellman-Ford trails the queue based one on every bundled
+	// input, so it only runs when asked for by name
+	engines.erase(find(engines.begin(), engines.end(), string("bellmanfordparallel")));
+	int numThreads = 1;
+
+	int a = 2;
+	for (; a + 1 < argc && argv[a][0] == '-'; a += 2)
+	{
+		string option = argv[a], value = argv[a + 1];
+		if (option == "-format" && (value == "json" || value == "csv"))
+			format = value == "json" ? jsonFormat : csvFormat;
+		else if (option == "-threads")
+			numThreads = atoi(value.c_str());
+		else if (option == "-engines")
+		{
+			engines.clear();
+			istringstream names(value);
+			string name;
+			while (getline(names, name, ','))
+			{
+				if (!isEngine(name, graphEngines, numGraphEngines) &&
+					!isEngine(name, mazeEngines, numMazeEngines))
+				{
+					cerr << "unknown engine " << name << endl;
+					return 1;
+				}
+				engines.push_back(name);
+			}
+		}
+		else
+		{
+			cerr << "bad option " << option << " " << value << endl;
+			return 1;
+		}
+	}
+	if (a == argc)
+	{
+		cerr << "usage: lic-5 -sweep [-format json|csv] [-engines name,...] "
+			"[-threads n] file..." << endl;
+		return 1;
+	}
+
+	writeSweepHeader(cout, format);
+	for (; a < argc; a++)
+		sweepFile(argv[a], engines, numThreads, format, cout);
+	cout.flush();
+	return 0;
+}
+
+// all pairs mode: lic-5 -apsp [-method auto|johnson|floyd] [-threads n] graphFile
+// prints the row of weights from each vertex, with - where there is no
+// path.  method defaults to auto, which picks by the graph's density.
+// returns main's exit status
+int runAllPairs(int argc, char *argv[])
+{
+	allPairsMethod method = autoAllPairs;
+	int numThreads = 0;
+
+	int a = 2;
+	for (; a + 1 < argc && argv[a][0] == '-'; a += 2)
+	{
+		string option = argv[a], value = argv[a + 1];
+		if (option == "-method" && (value == "auto" || value == "johnson" || value == "floyd"))
+			method = value == "auto" ? autoAllPairs :
+				value == "johnson" ? johnsonAllPairs : floydWarshallAllPairs;
+		else if (option == "-threads")
+			numThreads = atoi(value.c_str());
+		else
+		{
+			cerr << "bad option " << option << " " << value << endl;
+			return 1;
+		}
+	}
+	if (a + 1 != argc)
+	{
+		cerr << "usage: lic-5 -apsp [-method auto|johnson|floyd] [-threads n] graphFile" << endl;
+		return 1;
+	}
+
+	csrGraph g;
+	int start, end;
+	{
+		StatPhase(loadMs);
+		loadGraph(argv[a], g, start, end, numThreads);
+	}
+
+	matrix<int> dist;
+	bool b;
+	{
+		StatPhase(solveMs);
+		b = allPairs(g, dist, bellmanFordQueue,
+			[](const csrGraph &g, int s, searchContext &ctx) { dijkstra(g, s, ctx); },
+			method, numThreads);
+	}
+
+	// collect the output and write it once
+	ostringstream out;
+	if (!b)
+		out << "negative cycle found, no shortest paths exist\n";
+	else
+		for (int u = 0; u < g.numVertices(); u++)
+		{
+			out << u << ":";
+			const int *row = dist.data() + (size_t)u * g.numVertices();
+			for (int v = 0; v < g.numVertices(); v++)
+			{
+				if (row[v] == LargeValue)
+					out << " -";
+				else
+					out << " " << row[v];
+			}
+			out << "\n";
+		}
+	string text = out.str();
+	cout.write(text.data(), text.size());
+	cout.flush();
+	StatDump(cerr);
+	return 0;
+}
+
+// bench.cpp compiles this file in with LicNoMain defined and supplies its
+// own main
+#ifndef LicNoMain
+int main(int argc, char *argv[])
+{
+	try
+	{
+		// cache conversion: lic-5 -graphcache graphX.txt graphX.bin
+		//               or: lic-5 -mazecache mazeX.txt mazeX.bin
+		// loadGraph and maze(fileName) recognise the binary files
+		if (argc == 4 && string(argv[1]) == "-graphcache")
+		{
+			csrGraph g;
+			int start, end;
+			loadGraph(argv[2], g, start, end);
+			saveGraphCache(argv[3], g, start, end);
+			return 0;
+		}
+		if (argc == 4 && string(argv[1]) == "-mazecache")
+		{
+			maze m{ string(argv[2]) };
+			m.saveCache(argv[3]);
+			return 0;
+		}
+
+		if (argc >= 2 && string(argv[1]) == "-sweep")
+			return runSweep(argc, argv);
+		if (argc >= 2 && string(argv[1]) == "-apsp")
+			return runAllPairs(argc, argv);
+
+		// batch mode: lic-5 graphFile queryFile [numThreads]
+		if (argc >= 3)
+		{
+			runBatch(argv[1], argv[2], argc >= 4 ? atoi(argv[3]) : 0);
+			return 0;
+		}
 
 		// Read the graph from the file.
 		string fileName;
 		cout << "Enter a graph file graphX.txt: ";
 		cin >> fileName;
-		fin.open(fileName.c_str());
-		if (!fin)
-		{
-			cerr << "Cannot open " << fileName << endl;
-			exit(1);
-		}
 
 		// create graph from file
-		Graph g;
-		Vertex start, end;
-		initializeGraph(g, start, end, fin);
-		fin.close();
+		csrGraph g;
+		int start, end;
+		{
+			StatPhase(loadMs);
+			loadGraph(fileName, g, start, end);
+		}
 
 		// perform bellman-ford
-		bool b = bellmanFord(g, start);
+		searchContext ctx;
+		bool b;
+		{
+			StatPhase(solveMs);
+			b = bellmanFordQueue(g, start, ctx);
+		}
 
 		// build stack for printing
 		cout << "Bellman-Ford ";
 		stack<Vertex> s;
-		Vertex curr = end;
+		int curr = end;
 		// if no negative cycles
 		if (b)
 		{
 			while (curr != LargeValue)
 			{
 				s.push(curr);
-				curr = g[curr].pred;
+				curr = ctx.pred[curr];
 			}
 		}
 		// if negative cycles
@@ -342,14 +1351,35 @@ int main()
 		{
 			s.empty();
 		}
-		printPath(s);
+		{
+			StatPhase(renderMs);
+			printPath(s);
+		}
 
 		// perform dijkstra's
+		// only the path to end is needed, so search from both ends unless
+		// there are negative weights, in which case search out from start
+		// until end is settled
 		cout << "Dijkstra ";
 		bool d, neg = false;
 		try
 		{
-			d = dijkstra(g, start);
+			if (g.minEdgeWeight() >= 0)
+			{
+				searchContext bwd;
+				csrGraph rev;
+				{
+					StatPhase(buildMs);
+					rev = g.reversed();
+				}
+				StatPhase(solveMs);
+				d = bidirectionalDijkstra(g, rev, start, end, ctx, bwd);
+			}
+			else
+			{
+				StatPhase(solveMs);
+				d = dijkstra(g, start, end, ctx);
+			}
 		}
 		// if hit a neg number
 		catch (rangeError e)
@@ -365,18 +1395,30 @@ int main()
 			while (curr != LargeValue)
 			{
 				s.push(curr);
-				curr = g[curr].pred;
+				curr = ctx.pred[curr];
 			}
 		}
 		else
 		{
 			s.empty();
 		}
-		printPath(s);
+		{
+			StatPhase(renderMs);
+			printPath(s);
+		}
 
+		// what the run did, when built with LicStats
+		StatDump(cerr);
 	}
 	catch (fileOpenError e)
 	{
-		//noop
+		cerr << e.what() << endl;
+		return 1;
 	}
-}
\ No newline at end of file
+	catch (fileError e)
+	{
+		cerr << e.what() << endl;
+		return 1;
+	}
+}
+#endif
\ No newline at end of file
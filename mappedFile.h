@@ -0,0 +1,127 @@
+// mappedFile.h header file
+//
+// Read-only memory mapping of a whole file.
+//
+// The file's bytes are mapped straight into the address space, so a loader
+// can scan them in place instead of copying them through a stream buffer,
+// and pages are only read from disk as the scan reaches them.
+
+#ifndef MappedFile_h
+#define MappedFile_h
+
+#include <stddef.h>
+#include <string>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "d_except.h"
+
+class mappedFile
+{
+public:
+	mappedFile(const string &fileName);
+	// Map fileName for reading.  Throws fileOpenError if it can't be opened
+	// or mapped.
+
+	~mappedFile();
+
+	const char *data() const { return begin; }
+	size_t size() const { return length; }
+
+private:
+	mappedFile(const mappedFile &);
+	mappedFile &operator=(const mappedFile &);
+
+	const char *begin;   // first byte of the file, or NULL if it is empty
+	size_t length;       // number of bytes in the file
+#ifdef _WIN32
+	HANDLE file, mapping;
+#endif
+};
+
+#ifdef _WIN32
+
+mappedFile::mappedFile(const string &fileName)
+	: begin(NULL), length(0), file(INVALID_HANDLE_VALUE), mapping(NULL)
+{
+	file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	LARGE_INTEGER size;
+	if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size))
+	{
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+		throw fileOpenError(fileName);
+	}
+	length = (size_t)size.QuadPart;
+	if (length == 0)
+		return;
+
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping != NULL)
+		begin = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (begin == NULL)
+	{
+		if (mapping != NULL)
+			CloseHandle(mapping);
+		CloseHandle(file);
+		throw fileOpenError(fileName);
+	}
+}
+
+mappedFile::~mappedFile()
+{
+	if (begin != NULL)
+		UnmapViewOfFile(begin);
+	if (mapping != NULL)
+		CloseHandle(mapping);
+	CloseHandle(file);
+}
+
+#else
+
+mappedFile::mappedFile(const string &fileName)
+	: begin(NULL), length(0)
+{
+	int fd = open(fileName.c_str(), O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) != 0)
+	{
+		if (fd >= 0)
+			close(fd);
+		throw fileOpenError(fileName);
+	}
+	length = (size_t)st.st_size;
+	if (length > 0)
+	{
+		void *p = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p == MAP_FAILED)
+		{
+			close(fd);
+			throw fileOpenError(fileName);
+		}
+		// the loaders read front to back
+		madvise(p, length, MADV_SEQUENTIAL);
+		begin = (const char *)p;
+	}
+	// the mapping stays valid after the descriptor is closed
+	close(fd);
+}
+
+mappedFile::~mappedFile()
+{
+	if (begin != NULL)
+		munmap((void *)begin, length);
+}
+
+#endif
+
+#endif
@@ -1,67 +1,103 @@
 // Sample solution for project #5
 
+#ifndef Maze_h
+#define Maze_h
+
+#include <ctype.h>
 #include <iostream>
 #include <limits.h>
+#include <stdint.h>
+#include <string.h>
+#include <sstream>
 #include <list>
 #include <fstream>
 #include <queue>
 #include <vector>
 #include <stack>
 
-#include <boost/graph/adjacency_list.hpp>
-
 #include "d_except.h"
 #include "d_matrix.h"
+#include "graph.h"
+#include "csrGraph.h"
+#include "mappedFile.h"
+#include "binaryCache.h"
+#include "solverStats.h"
 
-#define LargeValue 99999999
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 using namespace boost;
 
-struct VertexProperties;
-struct EdgeProperties;
-
-typedef adjacency_list<vecS, vecS, bidirectionalS, VertexProperties, EdgeProperties> Graph;
-typedef Graph::vertex_descriptor Vertex;
-typedef pair<Graph::edge_descriptor, bool> Edge;
+// printPath's every argument for a single frame showing the whole path
+#define PrintWholePath 0
 
-struct VertexProperties
-{
-	pair<int, int> cell; // maze cell (x,y) value
-	Graph::vertex_descriptor pred; // predecessor node
-	int weight;
-	bool visited;
-	bool marked;
-};
-
-// Create a struct to hold properties for each edge
-struct EdgeProperties
-{
-	int weight;
-	bool visited;
-	bool marked;
-};
+// the maze's matrices check their indices only in debug builds
+#ifdef NDEBUG
+typedef uncheckedIndex mazeIndexCheck;
+#else
+typedef checkedIndex mazeIndexCheck;
+#endif
 
 class maze
 {
 public:
 	maze(ifstream &fin);
+	maze(const string &fileName);
+	maze(const maze &m);
+	maze &operator=(const maze &m);
 	void print(int, int, int, int);
 	bool isLegal(int i, int j);
 	void mapMazeToGraph(Graph &g);
+	void mapMazeToGraph(csrGraph &g);
 	void printPath(Graph::vertex_descriptor end,
 		stack<Graph::vertex_descriptor> &s,
-		Graph g);
-	int numRows() { return rows; };
-	int numCols() { return cols; };
+		Graph g, int every = 1);
+	void printPath(int end, stack<int> &s, const csrGraph &g, int every = 1);
+	void printPath(pair<int, int> end, stack<pair<int, int> > &s, int every = 1);
+	// Print the path in s, which runs from the top of the stack to end, and
+	// empty s.  With every = k > 0 the maze is printed as print() does at
+	// every kth step of the path and at the last one, so k = 1 shows each
+	// step.  With every = PrintWholePath it is printed once, with the whole
+	// path marked.
+	int numRows() const { return rows; };
+	int numCols() const { return cols; };
 	Vertex getNode(int i, int j) { return nodes[i][j]; };
+	// Vertex of cell (i,j) in the graph last built by mapMazeToGraph.
+
+	bool isOpen(int i, int j) const
+	// Return whether cell (i,j) is open, without checking i and j.
+	{
+		return (bits[(size_t)i * rowWords + (j >> 6)] >> (j & 63)) & 1;
+	}
+
+	int wordsPerRow() const { return rowWords; }
+	const uint64_t *bitmap() const { return bits; }
+	// The open cells, one bit each.  Row i takes up words i * wordsPerRow()
+	// through (i + 1) * wordsPerRow() - 1, and column j of a row is bit
+	// j % 64 of its word j / 64.  Bits past the last column are 0.
+
+	void saveCache(const string &fileName) const;
+	// Write the maze to fileName as a maze cache, which maze(const string &)
+	// maps and reads in place.
 
 private:
+	void allocate(int numRows, int numCols);
+	bool packRow(const char *cells, uint64_t *words);
+	void loadCache(const string &fileName, const std::shared_ptr<mappedFile> &file);
+	void drawFrame(string &frame) const;
+	void printCells(pair<int, int> end, const vector<pair<int, int> > &path, int every);
+
 	int rows; // number of rows in the maze
-	int cols; // number of columns in the maze12 a
+	int cols; // number of columns in the maze
 
-	matrix<bool> value;
-	matrix<Graph::vertex_descriptor> nodes;
+	int rowWords;           // 64-bit words per row of the bitmap
+	matrix<bool, mazeIndexCheck> open; // set if the cell is open, unless the
+	                        // bitmap is read from a mapped cache
+	const uint64_t *bits;   // the bitmap in use, open's or the cache's
+	std::shared_ptr<const void> owner; // keeps a mapped cache alive
+	matrix<Graph::vertex_descriptor, mazeIndexCheck> nodes; // sized by mapMazeToGraph
 };
 
 maze::maze(ifstream &fin)
@@ -73,65 +109,315 @@ maze::maze(ifstream &fin)
 
 	char x;
 
-	nodes.resize(rows, cols);
-	value.resize(rows, cols);
+	allocate(rows, cols);
 	for (int i = 0; i <= rows - 1; i++)
 		for (int j = 0; j <= cols - 1; j++)
 		{
 			fin >> x;
 			if (x == 'O')
-				value[i][j] = true;
-			else
-				value[i][j] = false;
+				open[i][j] = true;
 		}
 
 }
 
+maze::maze(const string &fileName)
+// Initializes a maze from the file fileName, which is in the format
+// maze(ifstream &) reads, with each row on a line of its own.  The file is
+// mapped into memory and converted a row at a time.  Throws fileError
+// naming the line of the first row that is short or holds something other
+// than 'O', 'X' or '*'.  A '*' marks a cell in some of the sample mazes
+// and, as in maze(ifstream &), is read as closed.  Anything after the last
+// row is ignored.  If fileName is a maze cache, its bitmap is used where it
+// lies in the mapped file instead.
+{
+	std::shared_ptr<mappedFile> file = std::make_shared<mappedFile>(fileName);
+	if (isMazeCache(*file))
+	{
+		loadCache(fileName, file);
+		return;
+	}
+
+	const char *p = file->data();
+	const char *end = p + file->size();
+	int line = 1;
+
+	auto fail = [&](const string &msg)
+	{
+		ostringstream err;
+		err << fileName << " line " << line << ": " << msg;
+		throw fileError(err.str());
+	};
+
+	// move p past whitespace, counting lines
+	auto skipSpace = [&]()
+	{
+		for (; p < end && isspace((unsigned char)*p); p++)
+			if (*p == '\n')
+				line++;
+	};
+
+	auto readCount = [&](const char *what)
+	{
+		skipSpace();
+		if (p == end || !isdigit((unsigned char)*p))
+			fail(string("expected the number of ") + what);
+		int n = 0;
+		for (; p < end && isdigit((unsigned char)*p); p++)
+		{
+			n = n * 10 + (*p - '0');
+			if (n > 1000000)
+				fail(string("too many ") + what);
+		}
+		return n;
+	};
+
+	int numRows = readCount("rows");
+	int numCols = readCount("columns");
+	allocate(numRows, numCols);
+
+	for (int i = 0; i < rows; i++)
+	{
+		skipSpace();
+		if (p == end)
+		{
+			ostringstream msg;
+			msg << "expected row " << i << " of " << rows << ", found end of file";
+			fail(msg.str());
+		}
+
+		const char *lineEnd = (const char *)memchr(p, '\n', end - p);
+		if (lineEnd == NULL)
+			lineEnd = end;
+		const char *cellsEnd = lineEnd;
+		if (cellsEnd > p && cellsEnd[-1] == '\r')
+			cellsEnd--;
+
+		// the last row may be followed by an end marker on the same line
+		long long length = cellsEnd - p;
+		if (length < cols || (length > cols && i < rows - 1))
+		{
+			ostringstream msg;
+			msg << "row " << i << " has " << length << " cells, expected " << cols;
+			fail(msg.str());
+		}
+		if (!packRow(p, open.row(i)))
+		{
+			int j = 0;
+			while (p[j] == 'O' || p[j] == 'X' || p[j] == '*')
+				j++;
+			ostringstream msg;
+			msg << "row " << i << " has '" << p[j] << "' in column " << j << ", expected 'O' or 'X'";
+			fail(msg.str());
+		}
+		p = lineEnd;
+	}
+}
+
+void maze::allocate(int numRows, int numCols)
+// Set the size of the maze, with every cell closed.
+{
+	rows = numRows;
+	cols = numCols;
+	open = matrix<bool, mazeIndexCheck>(rows, cols);
+	rowWords = open.rowWords();
+	bits = open.data();
+	owner.reset();
+	StatBytes(matrixBytes, open.bytes());
+}
+
+maze::maze(const maze &m)
+	: rows(m.rows), cols(m.cols), rowWords(m.rowWords), open(m.open), bits(m.bits),
+	owner(m.owner), nodes(m.nodes)
+{
+	if (!owner)
+		bits = open.data();
+}
+
+maze &maze::operator=(const maze &m)
+{
+	rows = m.rows;
+	cols = m.cols;
+	rowWords = m.rowWords;
+	open = m.open;
+	owner = m.owner;
+	nodes = m.nodes;
+	bits = owner ? m.bits : open.data();
+	return *this;
+}
+
+void maze::loadCache(const string &fileName, const std::shared_ptr<mappedFile> &file)
+// Read the maze cache in file in place, keeping file mapped for as long as
+// this maze or a copy of it needs it.
+{
+	mazeCacheHeader h;
+	if (file->size() >= sizeof(h))
+		memcpy(&h, file->data(), sizeof(h));
+	checkCacheHeader(fileName, *file, sizeof(h), h.version);
+	if (h.rows < 1 || h.cols < 1 || h.wordsPerRow != (h.cols + 63) / 64 ||
+		file->size() != sizeof(h) + (size_t)h.rows * h.wordsPerRow * sizeof(uint64_t))
+		throw fileError(fileName + ": cache size doesn't match its header");
+
+	// the searches read whole words, so a bit past the last column would
+	// open a cell that isn't in the maze
+	const uint64_t *words = (const uint64_t *)(file->data() + sizeof(h));
+	if (h.cols % 64 != 0)
+	{
+		uint64_t padding = ~(uint64_t)0 << (h.cols % 64);
+		for (int i = 0; i < h.rows; i++)
+			if (words[((size_t)i + 1) * h.wordsPerRow - 1] & padding)
+				throw fileError(fileName + ": cache row " + to_string(i) +
+					" has cells open past its last column");
+	}
+
+	rows = h.rows;
+	cols = h.cols;
+	rowWords = h.wordsPerRow;
+	open = matrix<bool, mazeIndexCheck>(0, 0);
+	bits = words;
+	owner = file;
+	// mapped rather than allocated, but the bitmap the solvers read all
+	// the same
+	StatBytes(matrixBytes, (size_t)rows * rowWords * sizeof(uint64_t));
+}
+
+void maze::saveCache(const string &fileName) const
+{
+	saveMazeCache(fileName, rows, cols, rowWords, bits);
+}
+
+bool maze::packRow(const char *cells, uint64_t *words)
+// Set the bits in words for the 'O's among the cols characters at cells.
+// Returns false if any of them is not 'O', 'X' or '*'.
+{
+	int j = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+	// 16 cells at a time, each compare giving one bit per cell; 16 divides
+	// 64, so a block never straddles two words
+	const __m128i o = _mm_set1_epi8('O');
+	const __m128i x = _mm_set1_epi8('X');
+	const __m128i star = _mm_set1_epi8('*');
+	for (; j + 16 <= cols; j += 16)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i *)(cells + j));
+		unsigned isO = _mm_movemask_epi8(_mm_cmpeq_epi8(v, o));
+		unsigned closed = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, x), _mm_cmpeq_epi8(v, star)));
+		if ((isO | closed) != 0xFFFF)
+			return false;
+		words[j >> 6] |= (uint64_t)isO << (j & 63);
+	}
+#endif
+	for (; j < cols; j++)
+	{
+		if (cells[j] == 'O')
+			words[j >> 6] |= (uint64_t)1 << (j & 63);
+		else if (cells[j] != 'X' && cells[j] != '*')
+			return false;
+	}
+	return true;
+}
+
+void maze::drawFrame(string &frame) const
+// Fill frame with the maze as print() shows it, but with no cells marked:
+// a blank line, each row on a line of its own, then another blank line.
+// Row i starts at frame[1 + i * (cols + 1)].
+{
+	frame.assign(1 + (size_t)rows * (cols + 1) + 1, 'X');
+	frame[0] = '\n';
+	for (int i = 0; i < rows; i++)
+	{
+		char *row = &frame[1 + (size_t)i * (cols + 1)];
+		for (int j = 0; j < cols; j++)
+			if (isOpen(i, j))
+				row[j] = ' ';
+		row[cols] = '\n';
+	}
+	frame[frame.size() - 1] = '\n';
+}
+
 void maze::print(int goalI, int goalJ, int currI, int currJ)
 // Print out a maze, with the goal and current cells marked on the
 // board.
 {
-	cout << endl;
-
 	if (goalI < 0 || goalI > rows || goalJ < 0 || goalJ > cols)
 		throw rangeError("Bad value in maze::print");
 
 	if (currI < 0 || currI > rows || currJ < 0 || currJ > cols)
 		throw rangeError("Bad value in maze::print");
 
-	for (int i = 0; i <= rows - 1; i++)
+	vector<pair<int, int> > path(1, make_pair(currI, currJ));
+	printCells(make_pair(goalI, goalJ), path, 1);
+}
+
+void maze::printCells(pair<int, int> end, const vector<pair<int, int> > &path, int every)
+// Print the frames printPath asks for.  Each frame is drawn into one
+// buffer and written in a single call, without flushing, so a large maze
+// costs one pass over its cells per frame rather than a stream operation
+// per cell.
+{
+	if (path.empty())
+		return;
+	StatPhase(renderMs);
+	string frame;
+	drawFrame(frame);
+
+	// where cell (i,j) is in frame, or npos for a cell off the board,
+	// which print() allows one past each edge
+	auto at = [&](pair<int, int> c)
 	{
-		for (int j = 0; j <= cols - 1; j++)
-		{
-			if (i == goalI && j == goalJ)
-				cout << "*";
-			else
-				if (i == currI && j == currJ)
-					cout << "+";
-				else
-					if (value[i][j])
-						cout << " ";
-					else
-						cout << "X";
-		}
-		cout << endl;
+		if (c.first < 0 || c.first >= rows || c.second < 0 || c.second >= cols)
+			return string::npos;
+		return 1 + (size_t)c.first * (cols + 1) + c.second;
+	};
+	size_t goal = at(end);
+
+	if (every == PrintWholePath)
+	{
+		for (size_t k = 0; k < path.size(); k++)
+			if (at(path[k]) != string::npos)
+				frame[at(path[k])] = '+';
+		if (goal != string::npos)
+			frame[goal] = '*';
+		cout.write(frame.data(), frame.size());
+		return;
+	}
+
+	if (goal != string::npos)
+		frame[goal] = '*';
+	for (size_t k = 0; k < path.size(); k++)
+	{
+		if (k % every != 0 && k != path.size() - 1)
+			continue;
+		// the goal's mark wins over the current cell's
+		size_t curr = at(path[k]);
+		char under = curr != string::npos ? frame[curr] : 0;
+		if (curr != string::npos && curr != goal)
+			frame[curr] = '+';
+		cout.write(frame.data(), frame.size());
+		if (curr != string::npos)
+			frame[curr] = under;
 	}
-	cout << endl;
 }
 
 bool maze::isLegal(int i, int j)
 // Return the value stored at the (i,j) entry in the maze, indicating
 // whether it is legal to go to cell (i,j).
 {
-	if (i < 0 || i > rows || j < 0 || j > cols)
+	if (i < 0 || i >= rows || j < 0 || j >= cols)
 		throw rangeError("Bad value in maze::isLegal");
 
-	return value[i][j];
+	return isOpen(i, j);
 }
 
 void maze::mapMazeToGraph(Graph &g)
 // Create a graph g that represents the legal moves in the maze m.
+// Every move costs 1.
 {
+	EdgeProperties e;
+	e.weight = 1;
+	e.visited = false;
+	e.marked = false;
+
+	nodes.resize(rows, cols);
 	for (int i = 0; i < rows; i++)
 	{
 		for (int j = 0; j < cols; j++)
@@ -151,8 +437,8 @@ void maze::mapMazeToGraph(Graph &g)
 					if (isLegal(i - 1, j))
 					{
 						// create bidirectional edges
-						Edge e_up = add_edge(v, nodes[i - 1][j], g);
-						Edge e_down = add_edge(nodes[i - 1][j], v, g);
+						add_edge(v, nodes[i - 1][j], e, g);
+						add_edge(nodes[i - 1][j], v, e, g);
 					}
 				}
 				// if in bounds
@@ -162,27 +448,111 @@ void maze::mapMazeToGraph(Graph &g)
 					if (isLegal(i, j - 1))
 					{
 						// create bidirectional edges
-						Edge e_left = add_edge(v, nodes[i][j - 1], g);
-						Edge e_right = add_edge(nodes[i][j - 1], v, g);
+						add_edge(v, nodes[i][j - 1], e, g);
+						add_edge(nodes[i][j - 1], v, e, g);
 					}
 				}
 			}
 		}
 	}
+
+	g[graph_bundle].minEdgeWeight = 1;
+	g[graph_bundle].maxEdgeWeight = 1;
+	StatBytes(boostGraphBytes, graphBytes(g));
+	StatBytes(matrixBytes, open.bytes() + nodes.bytes());
+}
+
+void maze::mapMazeToGraph(csrGraph &g)
+// Create a CSR graph g that represents the legal moves in the maze m,
+// without building a Boost graph first.  Vertices are numbered in row-major
+// order and out edges are listed up, left, right, down, which is the order
+// the Boost version ends up with.
+{
+	// Number the open cells
+	nodes.resize(rows, cols);
+	vector<pair<int, int> > cells;
+	for (int i = 0; i < rows; i++)
+		for (int j = 0; j < cols; j++)
+			if (isLegal(i, j))
+			{
+				nodes[i][j] = cells.size();
+				cells.push_back(make_pair(i, j));
+			}
+
+	// List the legal moves out of each cell
+	int n = (int)cells.size();
+	vector<int> offsets, targets;
+	offsets.reserve(n + 1);
+	targets.reserve(4 * (size_t)n);
+	offsets.push_back(0);
+	for (int v = 0; v < n; v++)
+	{
+		int i = cells[v].first;
+		int j = cells[v].second;
+		if (i > 0 && isLegal(i - 1, j))
+			targets.push_back((int)nodes[i - 1][j]);
+		if (j > 0 && isLegal(i, j - 1))
+			targets.push_back((int)nodes[i][j - 1]);
+		if (j < cols - 1 && isLegal(i, j + 1))
+			targets.push_back((int)nodes[i][j + 1]);
+		if (i < rows - 1 && isLegal(i + 1, j))
+			targets.push_back((int)nodes[i + 1][j]);
+		offsets.push_back((int)targets.size());
+	}
+	vector<int> weights(targets.size(), 1);
+
+	g = csrGraph(std::move(offsets), std::move(targets), std::move(weights), std::move(cells));
+	StatBytes(csrGraphBytes, g.bytes());
+	StatBytes(matrixBytes, open.bytes() + nodes.bytes());
 }
 
 void maze::printPath(Graph::vertex_descriptor end,
 	stack<Graph::vertex_descriptor> &s,
-	Graph g)
+	Graph g, int every)
+{
+	// if stack is empty, path was not found during search
+	if (s.size() == 0)
+		cout << "No path exists.\n";
+	// otherwise pop stack and print maze
+	vector<pair<int, int> > path;
+	while (s.size() > 0)
+	{
+		path.push_back(g[s.top()].cell);
+		s.pop();
+	}
+	printCells(g[end].cell, path, every);
+}
+
+void maze::printPath(int end, stack<int> &s, const csrGraph &g, int every)
+// Version of printPath for a graph built by mapMazeToGraph(csrGraph &).
+{
+	// if stack is empty, path was not found during search
+	if (s.size() == 0)
+		cout << "No path exists.\n";
+	// otherwise pop stack and print maze
+	vector<pair<int, int> > path;
+	while (s.size() > 0)
+	{
+		path.push_back(g.cell(s.top()));
+		s.pop();
+	}
+	printCells(g.cell(end), path, every);
+}
+
+void maze::printPath(pair<int, int> end, stack<pair<int, int> > &s, int every)
+// Version of printPath for a path of cells found directly on the maze.
 {
 	// if stack is empty, path was not found during search
 	if (s.size() == 0)
 		cout << "No path exists.\n";
 	// otherwise pop stack and print maze
+	vector<pair<int, int> > path;
 	while (s.size() > 0)
 	{
-		Vertex v = s.top();
+		path.push_back(s.top());
 		s.pop();
-		print(g[end].cell.first, g[end].cell.second, g[v].cell.first, g[v].cell.second);
 	}
-}
\ No newline at end of file
+	printCells(end, path, every);
+}
+
+#endif
@@ -0,0 +1,240 @@
+// parallelBellmanFord.h header file
+//
+// Implements a data-parallel Bellman-Ford over a flat edge list.
+//
+// The edges are regrouped by target into structure-of-arrays form
+// (offsets by target, then source and weight arrays), and a pass
+// computes, for a vertex v, the smallest of its current weight and
+// weight[u] + w over its in edges (u, v).  Only a vertex with an in edge
+// from a vertex whose weight changed in the last pass can improve, so
+// each pass takes just those, found through the out edges of the changed
+// vertices; a pass costs the edges around the frontier rather than the
+// whole graph.  Every vertex is owned by exactly one thread and a pass
+// reads only the previous pass's weights, so threads never write to the
+// same memory.  The min over a vertex's in edges is done eight edges at a
+// time with AVX2 gathers when the compiler targets AVX2.
+//
+// Pass k still leaves every vertex at most its shortest path of k edges,
+// so the usual numVertices - 1 pass bound and the final negative-cycle
+// check give the same weights and the same answer as bellmanFord.  Only
+// the weights are the same, though: where two shortest paths tie, the
+// pred may be a different edge from the one bellmanFord picks.
+
+#ifndef ParallelBellmanFord_h
+#define ParallelBellmanFord_h
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "csrGraph.h"
+#include "passBarrier.h"
+#include "searchContext.h"
+#include "solverStats.h"
+
+class inEdgeList
+// The edges of a graph grouped by target.  The in edges of v are entries
+// offsets[v] .. offsets[v + 1] - 1 of src and weight.  The targets of the
+// out edges of u are entries outOffsets[u] .. outOffsets[u + 1] - 1 of
+// outTarget.
+{
+public:
+	inEdgeList(const csrGraph &g);
+
+	int numVertices() const { return n; }
+	int numEdges() const { return (int)src.size(); }
+
+	vector<int> offsets;
+	vector<int> src;
+	vector<int> weight;
+	vector<int> outOffsets;
+	vector<int> outTarget;
+
+private:
+	int n;
+};
+
+inEdgeList::inEdgeList(const csrGraph &g)
+	: offsets(g.numVertices() + 1, 0), src(g.numEdges()), weight(g.numEdges()),
+	outOffsets(g.offsetArray(), g.offsetArray() + g.numVertices() + 1),
+	outTarget(g.targetArray(), g.targetArray() + g.numEdges()), n(g.numVertices())
+{
+	// Count the in degree of each vertex, then turn the counts into offsets
+	for (int e = 0; e < g.numEdges(); e++)
+		offsets[g.target(e) + 1]++;
+	for (int v = 0; v < n; v++)
+		offsets[v + 1] += offsets[v];
+
+	// Sources of each vertex stay in increasing order
+	vector<int> next(offsets.begin(), offsets.end() - 1);
+	for (int u = 0; u < n; u++)
+		for (int e = g.beginEdge(u); e < g.endEdge(u); e++)
+		{
+			int k = next[g.target(e)]++;
+			src[k] = u;
+			weight[k] = g.weight(e);
+		}
+}
+
+bool relaxInEdges(const inEdgeList &g, int v, const int *cur, int *next, int *pred)
+// Set next[v] to the smaller of cur[v] and the best weight offered by an
+// in edge of v, recording the source of that edge in pred[v].  Returns
+// true if v improved.  The first in edge achieving the minimum wins, with
+// or without AVX2.
+{
+	int begin = g.offsets[v];
+	int end = g.offsets[v + 1];
+	const int *src = g.src.data();
+	const int *w = g.weight.data();
+
+	int best = cur[v];
+	int e = begin;
+#ifdef __AVX2__
+	if (end - begin >= 8)
+	{
+		__m256i vbest = _mm256_set1_epi32(best);
+		for (; e + 8 <= end; e += 8)
+		{
+			__m256i idx = _mm256_loadu_si256((const __m256i *)(src + e));
+			__m256i du = _mm256_i32gather_epi32(cur, idx, 4);
+			__m256i dw = _mm256_loadu_si256((const __m256i *)(w + e));
+			vbest = _mm256_min_epi32(vbest, _mm256_add_epi32(du, dw));
+		}
+		// Fold the eight lanes down to one
+		__m128i m = _mm_min_epi32(_mm256_castsi256_si128(vbest), _mm256_extracti128_si256(vbest, 1));
+		m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+		m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+		best = _mm_cvtsi128_si32(m);
+	}
+#endif
+	for (; e < end; e++)
+		if (cur[src[e]] + w[e] < best)
+			best = cur[src[e]] + w[e];
+
+	next[v] = best;
+	if (best >= cur[v])
+		return false;
+
+	// Find the first edge that gives the new weight
+	for (e = begin; cur[src[e]] + w[e] != best; e++)
+		;
+	pred[v] = src[e];
+	return true;
+}
+
+bool bellmanFordParallel(const inEdgeList &g, int s, searchContext &ctx, int numThreads = 0)
+// find lowest weight to each node in g starting from vertex s, leaving the
+// weights and preds in ctx, using numThreads threads (0 for one per core)
+// the weights match bellmanFord's; where shortest paths tie, the preds may not
+// can operate on negatives
+// will return false if it detects a negative cycle
+{
+	int n = g.numVertices();
+	ctx.reset(n, s);
+	if (numThreads <= 0)
+		numThreads = max(1, (int)thread::hardware_concurrency());
+	numThreads = min(numThreads, max(1, n));
+
+	// Split the vertices into ranges with about the same number of in edges
+	vector<int> split(numThreads + 1, n);
+	split[0] = 0;
+	for (int t = 1, v = 0; t < numThreads; t++)
+	{
+		long long want = (long long)g.numEdges() * t / numThreads;
+		while (v < n && g.offsets[v] < want)
+			v++;
+		split[t] = v;
+	}
+
+	vector<int> other(n);
+	int *cur = ctx.dist.data();
+	int *next = other.data();
+	int *pred = ctx.pred.data();
+
+	// the vertices each thread lowered in the last pass, starting with s,
+	// and the vertices of its own each thread relaxes in this one
+	vector<vector<int> > changed(numThreads), active(numThreads);
+	vector<char> queued(n, false);
+	changed[0].push_back(s);
+	atomic<bool> negativeCycle(false);
+	bool done = false;
+	int passes = 0;
+	passBarrier barrier(numThreads);
+
+	auto work = [&](int t)
+	{
+		int first = split[t], last = split[t + 1];
+		while (true)
+		{
+			// queue the vertices of mine that an out edge of a changed
+			// vertex leads to
+			for (int c = 0; c < numThreads; c++)
+				for (int k = 0; k < (int)changed[c].size(); k++)
+				{
+					int u = changed[c][k];
+					for (int e = g.outOffsets[u]; e < g.outOffsets[u + 1]; e++)
+					{
+						int v = g.outTarget[e];
+						if (v >= first && v < last && !queued[v])
+						{
+							queued[v] = true;
+							active[t].push_back(v);
+						}
+					}
+				}
+			barrier.wait([]() {});
+
+			changed[t].clear();
+			for (int k = 0; k < (int)active[t].size(); k++)
+			{
+				int v = active[t][k];
+				queued[v] = false;
+				if (relaxInEdges(g, v, cur, next, pred))
+					changed[t].push_back(v);
+			}
+			active[t].clear();
+
+			// if a whole pass changes nothing, no later pass can either;
+			// loop for at most numVertices - 1 passes
+			barrier.wait([&]()
+			{
+				passes++;
+				bool any = false;
+				for (int c = 0; c < numThreads; c++)
+					any = any || !changed[c].empty();
+				done = !any || passes >= n - 1;
+			});
+			// the weights that changed become the current ones
+			for (int k = 0; k < (int)changed[t].size(); k++)
+				cur[changed[t][k]] = next[changed[t][k]];
+			if (done)
+				break;
+		}
+		barrier.wait([]() {});
+
+		// check each edge to ensure there are no cycles
+		for (int v = first; v < last && !negativeCycle; v++)
+			for (int e = g.offsets[v]; e < g.offsets[v + 1]; e++)
+				if (cur[v] > cur[g.src[e]] + g.weight[e])
+				{
+					negativeCycle = true;
+					break;
+				}
+	};
+
+	vector<thread> workers;
+	for (int t = 1; t < numThreads; t++)
+		workers.push_back(thread(work, t));
+	work(0);
+	for (int t = 0; t < (int)workers.size(); t++)
+		workers[t].join();
+	StatAdd(bellmanFordPasses, passes);
+
+	return !negativeCycle;
+}
+
+#endif
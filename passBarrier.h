@@ -0,0 +1,64 @@
+// passBarrier.h header file
+//
+// A reusable barrier for worker threads that proceed in lockstep passes.
+//
+// Passes can be short, so a waiting thread first spins briefly on the pass
+// counter, which catches a barrier the others are about to reach without
+// paying for a wakeup.  If the pass hasn't ended by then it sleeps on a
+// condition variable, so a waiter never holds a core that a thread still
+// working could use.
+
+#ifndef PassBarrier_h
+#define PassBarrier_h
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+using namespace std;
+
+class passBarrier
+// Blocks threads until all of them arrive, then lets the last one to
+// arrive run a step before releasing the rest.  Everything a thread wrote
+// before it arrived is visible to the step and to every thread after the
+// barrier.
+{
+public:
+	passBarrier(int numThreads) : count(numThreads), waiting(0), generation(0) {}
+
+	template <typename F>
+	void wait(F lastArrival)
+	{
+		int gen = generation.load(memory_order_acquire);
+		if (waiting.fetch_add(1, memory_order_acq_rel) + 1 == count)
+		{
+			lastArrival();
+			waiting.store(0, memory_order_relaxed);
+			{
+				// under the lock, so a waiter can't check the pass and
+				// then miss the wakeup
+				lock_guard<mutex> lock(sleep);
+				generation.store(gen + 1, memory_order_release);
+			}
+			wake.notify_all();
+			return;
+		}
+
+		for (int spins = 0; spins < spinLimit; spins++)
+			if (generation.load(memory_order_acquire) != gen)
+				return;
+		unique_lock<mutex> lock(sleep);
+		wake.wait(lock, [&]() { return generation.load(memory_order_acquire) != gen; });
+	}
+
+private:
+	enum { spinLimit = 200 };
+
+	int count;
+	atomic<int> waiting;
+	atomic<int> generation;
+	mutex sleep;
+	condition_variable wake;
+};
+
+#endif
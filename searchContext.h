@@ -0,0 +1,37 @@
+// searchContext.h header file
+//
+// Per-query state for the shortest path searches.
+//
+// A search over a csrGraph reads the graph and writes only to a
+// searchContext, so one loaded graph can serve any number of queries, each
+// with its own context.  The state is kept as separate arrays rather than
+// one struct per vertex, so the distance array a search spends its time in
+// stays dense.  A context can be reused for query after query; reset keeps
+// the arrays' storage.
+
+#ifndef SearchContext_h
+#define SearchContext_h
+
+#include <vector>
+
+#include "graph.h"
+#include "solverStats.h"
+
+struct searchContext
+{
+	vector<int> dist;      // current estimate of the distance from the source
+	vector<int> pred;      // predecessor on the best path found, or LargeValue
+	vector<char> settled;  // true once a vertex's distance is final
+
+	void reset(int numVertices, int s)
+	// Prepare for a search from s over a graph with numVertices vertices.
+	{
+		dist.assign(numVertices, LargeValue);
+		pred.assign(numVertices, LargeValue);
+		settled.assign(numVertices, false);
+		dist[s] = 0;
+		StatBytes(searchBytes, (dist.capacity() + pred.capacity()) * sizeof(int) + settled.capacity());
+	}
+};
+
+#endif
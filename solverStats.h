@@ -0,0 +1,133 @@
+// solverStats.h header file
+//
+// Counters, phase timers and memory figures that the solvers fill in, to
+// show where a slow solve spends its time.
+//
+// Everything here is compiled in only when LicStats is defined.  Otherwise
+// the Stat macros expand to nothing, so their arguments are not even
+// evaluated and the solvers run exactly as they would without them.
+//
+//   StatCount(counter)      add 1 to a counter
+//   StatAdd(field, n)       add n to a counter or phase time
+//   StatBytes(field, n)     note that a structure holds n bytes, keeping
+//                           the largest figure seen
+//   StatPhase(field)        add the time until the end of the enclosing
+//                           block to a phase
+//   StatDump(out)           write the figures to out as a line of JSON
+//
+// Each thread has its own figures, so the searches of a multi-threaded
+// batch don't contend for them; the driver reports the ones of the thread
+// that ran the solve.  currentStats().reset() starts them again from 0.
+
+#ifndef SolverStats_h
+#define SolverStats_h
+
+#ifdef LicStats
+
+#include <algorithm>
+#include <ostream>
+#include <stddef.h>
+
+#include "stopwatch.h"
+
+using namespace std;
+
+struct solverStats
+{
+	// priority queue operations, in every kind of queue
+	long long extractions;
+	long long inserts;
+	long long decreaseKeys;
+	long long indexLookups;      // heapV::getIndex calls, each one lookup
+	// edges looked at by a relaxation, and the ones that lowered a weight
+	long long relaxCalls;
+	long long relaxations;
+	long long bellmanFordPasses; // passes over every edge, or FIFO rounds
+	                             // of bellmanFordQueue
+
+	// milliseconds spent in each phase of a run
+	double loadMs;
+	double buildMs;
+	double solveMs;
+	double renderMs;
+
+	// the most bytes seen held by each kind of structure at once
+	size_t boostGraphBytes;
+	size_t csrGraphBytes;
+	size_t matrixBytes;
+	size_t heapBytes;
+	size_t searchBytes;          // searchContext arrays
+
+	solverStats() { reset(); }
+
+	void reset()
+	{
+		extractions = inserts = decreaseKeys = indexLookups = 0;
+		relaxCalls = relaxations = bellmanFordPasses = 0;
+		loadMs = buildMs = solveMs = renderMs = 0;
+		boostGraphBytes = csrGraphBytes = matrixBytes = heapBytes = searchBytes = 0;
+	}
+
+	void writeJson(ostream &out) const;
+	// Write the figures as one JSON object, without a line end.
+};
+
+void solverStats::writeJson(ostream &out) const
+{
+	out << "{\"counts\":{\"extractions\":" << extractions
+		<< ",\"inserts\":" << inserts
+		<< ",\"decrease_keys\":" << decreaseKeys
+		<< ",\"index_lookups\":" << indexLookups
+		<< ",\"relax_calls\":" << relaxCalls
+		<< ",\"relaxations\":" << relaxations
+		<< ",\"bellman_ford_passes\":" << bellmanFordPasses
+		<< "},\"phase_ms\":{\"load\":" << loadMs
+		<< ",\"build\":" << buildMs
+		<< ",\"solve\":" << solveMs
+		<< ",\"render\":" << renderMs
+		<< "},\"peak_bytes\":{\"boost_graph\":" << boostGraphBytes
+		<< ",\"csr_graph\":" << csrGraphBytes
+		<< ",\"matrix\":" << matrixBytes
+		<< ",\"heap\":" << heapBytes
+		<< ",\"search\":" << searchBytes
+		<< ",\"total\":" << boostGraphBytes + csrGraphBytes + matrixBytes + heapBytes + searchBytes
+		<< "}}";
+}
+
+solverStats &currentStats()
+// The calling thread's figures.
+{
+	static thread_local solverStats stats;
+	return stats;
+}
+
+class phaseTimer
+// Adds the time from its construction to its destruction to a phase.
+{
+public:
+	phaseTimer(double &phaseMs) : phase(phaseMs) {}
+	~phaseTimer() { phase += clock.ms(); }
+
+private:
+	double &phase;
+	stopwatch clock;
+};
+
+#define StatCount(counter) (currentStats().counter++)
+#define StatAdd(field, n) (currentStats().field += (n))
+#define StatBytes(field, n) \
+	(currentStats().field = max(currentStats().field, (size_t)(n)))
+#define StatPhase(field) phaseTimer statPhase##field(currentStats().field)
+#define StatDump(out) (currentStats().writeJson(out), (out) << '\n')
+
+#else
+
+#define StatCount(counter) ((void)0)
+#define StatAdd(field, n) ((void)0)
+#define StatBytes(field, n) ((void)0)
+#define StatPhase(field) ((void)0)
+#define StatDump(out) ((void)0)
+
+#endif
+
+#endif
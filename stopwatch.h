@@ -0,0 +1,39 @@
+// stopwatch.h header file
+//
+// Wall clock timing for the drivers that report how long each phase of a
+// run takes.  steady_clock is used, so the readings are not thrown off by
+// changes to the system time.
+
+#ifndef Stopwatch_h
+#define Stopwatch_h
+
+#include <chrono>
+
+class stopwatch
+{
+public:
+	stopwatch() { restart(); }
+
+	void restart() { begin = std::chrono::steady_clock::now(); }
+	// Start timing again from now.
+
+	double ms() const
+	// Milliseconds since the stopwatch was made or last restarted.
+	{
+		return std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - begin).count();
+	}
+
+	double lap()
+	// Milliseconds since the last restart, and restart.
+	{
+		double t = ms();
+		restart();
+		return t;
+	}
+
+private:
+	std::chrono::steady_clock::time_point begin;
+};
+
+#endif
@@ -0,0 +1,204 @@
+// sweepRecord.h header file
+//
+// Records written by the sweep driver, one per input file and engine, as
+// JSON lines or CSV.
+//
+// Each record holds the file and the engine, the size of the input, the
+// time taken to load the file, to build what the engine searches and to
+// search it, and the outcome.  Times are in milliseconds.  path_length is
+// the number of moves on the path found and path_cost their total weight,
+// both -1 if there is no path.  status is one of
+//   ok              a path was found
+//   no path         the end can't be reached from the start
+//   negative cycle  Bellman-Ford found a negative cycle reachable from the
+//                   start, so there is no shortest path
+//   failed          the engine can't search this input, e.g. dijkstra's on
+//                   a negative weight; message says why
+//   error           the file couldn't be read; message says why
+// A build with LicStats defined adds the solverStats of each run to its
+// JSON record.
+
+#ifndef SweepRecord_h
+#define SweepRecord_h
+
+#include <iomanip>
+#include <ostream>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+#include "d_except.h"
+#include "mappedFile.h"
+#include "binaryCache.h"
+#include "maze.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+enum sweepFormat { jsonFormat, csvFormat };
+
+struct sweepRecord
+{
+	string file;
+	string kind;          // "graph", "maze", or "unknown" if the file couldn't be read
+	string engine;
+	long long vertices;   // for a maze, its open cells
+	long long edges;      // for a maze, the moves between open cells
+	double loadMs;
+	double buildMs;
+	double solveMs;
+	string status;
+	long long pathLength;
+	long long pathCost;
+	string message;
+	string stats;         // solverStats as JSON, when built with LicStats
+
+	sweepRecord(const string &fileName = "", const string &fileKind = "unknown")
+		: file(fileName), kind(fileKind), engine("-"), vertices(0), edges(0),
+		loadMs(0), buildMs(0), solveMs(0), status("ok"), pathLength(-1), pathCost(-1)
+	{}
+};
+
+bool isMazeFile(const string &fileName)
+// Return true if fileName holds a maze, in text or as a maze cache, rather
+// than a graph.  A maze's two counts are followed by its cells, where a
+// graph's third number is its end vertex.  Throws fileOpenError if the file
+// can't be opened.
+{
+	mappedFile file(fileName);
+	if (isMazeCache(file))
+		return true;
+	if (isGraphCache(file))
+		return false;
+
+	const char *p = file.data();
+	const char *end = p + file.size();
+	for (int k = 0; k < 2; k++)
+	{
+		while (p < end && (unsigned char)*p <= ' ')
+			p++;
+		while (p < end && *p >= '0' && *p <= '9')
+			p++;
+	}
+	while (p < end && (unsigned char)*p <= ' ')
+		p++;
+	return p < end && (*p == 'O' || *p == 'X' || *p == '*');
+}
+
+int countBits(uint64_t bits)
+{
+#ifdef _MSC_VER
+	return (int)__popcnt64(bits);
+#else
+	return __builtin_popcountll(bits);
+#endif
+}
+
+void countMoves(const maze &m, long long &cells, long long &moves)
+// Set cells to the number of open cells in m and moves to the number of
+// moves between them, counting each direction, which are the vertex and
+// edge counts of mapMazeToGraph's graph.
+{
+	int wpr = m.wordsPerRow();
+	const uint64_t *bits = m.bitmap();
+	cells = moves = 0;
+	for (int i = 0; i < m.numRows(); i++)
+	{
+		const uint64_t *row = bits + (size_t)i * wpr;
+		for (int w = 0; w < wpr; w++)
+		{
+			cells += countBits(row[w]);
+			// a cell and the one to its right, the next word's first
+			// cell standing in for the bit shifted out
+			uint64_t right = row[w] >> 1;
+			if (w + 1 < wpr)
+				right |= row[w + 1] << 63;
+			moves += 2 * countBits(row[w] & right);
+			// a cell and the one below it
+			if (i + 1 < m.numRows())
+				moves += 2 * countBits(row[w] & row[w + wpr]);
+		}
+	}
+}
+
+string jsonString(const string &s)
+// s as a quoted JSON string.
+{
+	string out = "\"";
+	for (size_t k = 0; k < s.size(); k++)
+	{
+		unsigned char c = s[k];
+		if (c == '"' || c == '\\')
+			(out += '\\') += c;
+		else if (c < ' ')
+		{
+			char esc[8];
+			snprintf(esc, sizeof(esc), "\\u%04x", c);
+			out += esc;
+		}
+		else
+			out += c;
+	}
+	return out + "\"";
+}
+
+string csvField(const string &s)
+// s as a CSV field, quoted only if it has to be.
+{
+	if (s.find_first_of(",\"\r\n") == string::npos)
+		return s;
+	string out = "\"";
+	for (size_t k = 0; k < s.size(); k++)
+	{
+		if (s[k] == '"')
+			out += '"';
+		out += s[k];
+	}
+	return out + "\"";
+}
+
+void writeSweepHeader(ostream &out, sweepFormat format)
+// Write what goes before the first record: the column names for CSV.
+{
+	if (format == csvFormat)
+		out << "file,kind,engine,vertices,edges,load_ms,build_ms,solve_ms,"
+			"status,path_length,path_cost,message\n";
+}
+
+void writeSweepRecord(ostream &out, const sweepRecord &r, sweepFormat format)
+// Write r as one line of JSON or CSV.
+{
+	ios::fmtflags flags = out.flags();
+	streamsize precision = out.precision();
+	out << fixed << setprecision(3);
+	if (format == jsonFormat)
+	{
+		out << "{\"file\":" << jsonString(r.file)
+			<< ",\"kind\":" << jsonString(r.kind)
+			<< ",\"engine\":" << jsonString(r.engine)
+			<< ",\"vertices\":" << r.vertices
+			<< ",\"edges\":" << r.edges
+			<< ",\"load_ms\":" << r.loadMs
+			<< ",\"build_ms\":" << r.buildMs
+			<< ",\"solve_ms\":" << r.solveMs
+			<< ",\"status\":" << jsonString(r.status)
+			<< ",\"path_length\":" << r.pathLength
+			<< ",\"path_cost\":" << r.pathCost;
+		if (!r.message.empty())
+			out << ",\"message\":" << jsonString(r.message);
+		if (!r.stats.empty())
+			out << ",\"stats\":" << r.stats;
+		out << "}\n";
+	}
+	else
+		out << csvField(r.file) << ',' << r.kind << ',' << r.engine << ','
+			<< r.vertices << ',' << r.edges << ','
+			<< r.loadMs << ',' << r.buildMs << ',' << r.solveMs << ','
+			<< r.status << ',' << r.pathLength << ',' << r.pathCost << ','
+			<< csvField(r.message) << '\n';
+	out.flags(flags);
+	out.precision(precision);
+}
+
+#endif